@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Writes buffers to a file on a background thread, in the order they are queued, so the caller
+ * goes on with the next batch while the last one is written. At most `max_pending` buffers wait
+ * in the queue, a caller that gets further ahead blocks.
+ */
+class async_writer {
+    static constexpr size_t max_pending = 4;
+
+    std::ofstream           m_out;
+    std::thread             m_thread;
+    std::mutex              m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_space;
+    std::deque<std::string> m_queue;
+    bool                    m_closed = false;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_ready.wait(lock, [&] { return m_closed || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            std::string buf = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_space.notify_one();
+            lock.unlock();
+            m_out.write(buf.data(), buf.size());
+            lock.lock();
+        }
+    }
+
+   public:
+    async_writer(const std::string &path, std::ios_base::openmode mode) : m_out(path, mode) {
+        if (!m_out.is_open()) {
+            std::cerr << "Could not open file: " << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_thread = std::thread(&async_writer::run, this);
+    }
+
+    ~async_writer() { close(); }
+
+    async_writer(const async_writer &) = delete;
+    async_writer &operator=(const async_writer &) = delete;
+
+    void write(std::string buf) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_space.wait(lock, [&] { return m_queue.size() < max_pending; });
+        m_queue.push_back(std::move(buf));
+        m_ready.notify_one();
+    }
+
+    /* Writes out every queued buffer and closes the file. */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_ready.notify_one();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        m_out.close();
+    }
+};
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "doc_lens.hpp"
+#include "inverted_index.hpp"
+#include "score_bounds.hpp"
+
+/**
+ * Top-k BM25 retrieval over an `InvertedIndex`, document at a time, scoring with the parameters
+ * and collection statistics of a `ScoreBounds` built for the same index. MaxScore and Block-Max
+ * WAND skip documents whose upper bound cannot enter the top k, and postings are read from the
+ * block encoded lists of the bounds, so a skip over whole blocks never decodes them.
+ *
+ * Every algorithm returns the same documents and scores as an exhaustive evaluation: a score adds
+ * up the query terms in query order whichever order the pruning visits them in, a document enters
+ * the top k only with a score above the k-th one, and ties are ranked by document id.
+ */
+class bm25_retriever {
+   public:
+    enum algorithm { exhaustive, maxscore, block_max_wand };
+
+    struct result {
+        uint32_t docid;
+        double   score;
+    };
+
+   private:
+    static constexpr uint32_t end_doc = std::numeric_limits<uint32_t>::max();
+
+    /*
+     * A posting list, its bounds, the decoded block `current` it stands in and the block the last
+     * shallow move stopped in, which may be ahead of it. Past the end no block is decoded.
+     */
+    struct cursor {
+        const BlockPostings * postings;
+        const TermBounds *    bounds;
+        double                weight;
+        double                max_score;
+        std::vector<uint32_t> docs;
+        std::vector<uint32_t> freqs;
+        size_t                current = 0;
+        size_t                pos     = 0;
+        size_t                block   = 0;
+
+        uint32_t doc() const { return pos < docs.size() ? docs[pos] : end_doc; }
+    };
+
+    InvertedIndex &                         m_index;
+    const DocLens &                         m_doc_lens;
+    const ScoreBounds &                     m_bounds;
+    std::unordered_map<std::string, size_t> m_lists;
+    std::vector<cursor>                     m_cursors;
+    std::vector<size_t>                     m_order;
+    std::vector<double>                     m_upper;
+    std::vector<result>                     m_heap;
+    size_t                                  m_k      = 0;
+    size_t                                  m_scored = 0;
+
+    static bool better(const result &a, const result &b) {
+        return a.score > b.score || (a.score == b.score && a.docid < b.docid);
+    }
+
+    double threshold() const {
+        return m_heap.size() < m_k ? -std::numeric_limits<double>::infinity() : m_heap[0].score;
+    }
+
+    /* Adds a fully scored document, true if it entered the top k. */
+    bool push(uint32_t docid, double score) {
+        ++m_scored;
+        if (m_heap.size() < m_k) {
+            m_heap.push_back(result{docid, score});
+            std::push_heap(m_heap.begin(), m_heap.end(), better);
+            return true;
+        }
+        if (score <= m_heap[0].score) {
+            return false;
+        }
+        std::pop_heap(m_heap.begin(), m_heap.end(), better);
+        m_heap.back() = result{docid, score};
+        std::push_heap(m_heap.begin(), m_heap.end(), better);
+        return true;
+    }
+
+    double score(const cursor &c) const {
+        auto &bm25 = m_bounds.bm25;
+        return bm25.factor(c.freqs[c.pos], bm25.norm(m_doc_lens[c.docs[c.pos]])) * c.weight;
+    }
+
+    /* Score of `docid` from the cursors standing on it, in query order. */
+    double score(uint32_t docid) const {
+        double s = 0;
+        for (auto &&c : m_cursors) {
+            if (c.doc() == docid) {
+                s += score(c);
+            }
+        }
+        return s;
+    }
+
+    /* Decodes block `b` of `c` and stands on its first posting, past the end if there is none. */
+    void decode(cursor &c, size_t b) const {
+        c.current = b;
+        c.pos     = 0;
+        if (b == c.bounds->block_last.size()) {
+            c.docs.clear();
+            return;
+        }
+        uint32_t base = b ? c.bounds->block_last[b - 1] : 0;
+        c.postings->decode(b, m_bounds.block_size, base, c.docs, c.freqs);
+    }
+
+    /* Moves `c` to its next posting, decoding the next block at the end of one. */
+    void advance(cursor &c) const {
+        if (++c.pos == c.docs.size()) {
+            decode(c, c.current + 1);
+        }
+    }
+
+    /* Moves the block of `c` to the one holding `docid`, past the end if there is none. */
+    void shallow(cursor &c, uint32_t docid) const {
+        auto &last = c.bounds->block_last;
+        c.block    = std::max(c.block, c.current);
+        while (c.block < last.size() && last[c.block] < docid) {
+            ++c.block;
+        }
+    }
+
+    double block_max(const cursor &c) const {
+        return c.block < c.bounds->block_max.size() ? c.bounds->block_max[c.block] * c.weight : 0;
+    }
+
+    uint32_t block_last(const cursor &c) const {
+        return c.block < c.bounds->block_last.size() ? c.bounds->block_last[c.block] : end_doc;
+    }
+
+    /* Moves `c` to the first posting at or after `docid`, decoding only the block holding it. */
+    void next_geq(cursor &c, uint32_t docid) const {
+        if (c.doc() >= docid) {
+            return;
+        }
+        shallow(c, docid);
+        if (c.block != c.current) {
+            decode(c, c.block);
+        }
+        c.pos = std::lower_bound(c.docs.begin() + c.pos, c.docs.end(), docid) - c.docs.begin();
+    }
+
+    void run_exhaustive() {
+        while (true) {
+            uint32_t docid = end_doc;
+            for (auto &&c : m_cursors) {
+                docid = std::min(docid, c.doc());
+            }
+            if (docid == end_doc) {
+                break;
+            }
+            push(docid, score(docid));
+            for (auto &&c : m_cursors) {
+                if (c.doc() == docid) {
+                    advance(c);
+                }
+            }
+        }
+    }
+
+    /*
+     * Lists sorted by increasing bound. The lists whose bounds add up to at most the threshold are
+     * non-essential: a document only in those cannot enter the top k, so candidates come from the
+     * essential lists and the others are only probed while the document can still make it.
+     */
+    void run_maxscore() {
+        size_t n = m_cursors.size();
+        m_order.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            m_order[i] = i;
+        }
+        std::stable_sort(m_order.begin(), m_order.end(), [&](size_t a, size_t b) {
+            return m_cursors[a].max_score < m_cursors[b].max_score;
+        });
+        m_upper.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            m_upper[i] = (i ? m_upper[i - 1] : 0) + m_cursors[m_order[i]].max_score;
+        }
+
+        size_t   essential = 0;
+        uint32_t docid     = end_doc;
+        for (auto &&c : m_cursors) {
+            docid = std::min(docid, c.doc());
+        }
+        while (essential < n && docid != end_doc) {
+            double partial = 0;
+            for (size_t i = essential; i < n; ++i) {
+                auto &c = m_cursors[m_order[i]];
+                if (c.doc() == docid) {
+                    partial += score(c);
+                }
+            }
+            bool candidate = true;
+            for (size_t i = essential; i-- > 0;) {
+                if (partial + m_upper[i] <= threshold()) {
+                    candidate = false;
+                    break;
+                }
+                auto &c = m_cursors[m_order[i]];
+                next_geq(c, docid);
+                if (c.doc() == docid) {
+                    partial += score(c);
+                }
+            }
+            if (candidate && push(docid, score(docid))) {
+                while (essential < n && m_upper[essential] <= threshold()) {
+                    ++essential;
+                }
+            }
+
+            uint32_t next = end_doc;
+            for (size_t i = essential; i < n; ++i) {
+                auto &c = m_cursors[m_order[i]];
+                if (c.doc() == docid) {
+                    advance(c);
+                }
+                next = std::min(next, c.doc());
+            }
+            docid = next;
+        }
+    }
+
+    /*
+     * Lists sorted by their current document. The pivot is the first document whose lists up to
+     * it could beat the threshold with their list bounds; it is scored only if the bounds of the
+     * blocks holding it could too, otherwise the lists skip past the shortest of those blocks.
+     */
+    void run_block_max_wand() {
+        size_t n = m_cursors.size();
+        m_order.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            m_order[i] = i;
+        }
+        auto by_doc = [&](size_t a, size_t b) { return m_cursors[a].doc() < m_cursors[b].doc(); };
+
+        while (true) {
+            std::sort(m_order.begin(), m_order.end(), by_doc);
+            double upper = 0;
+            size_t pivot = n;
+            for (size_t i = 0; i < n && m_cursors[m_order[i]].doc() != end_doc; ++i) {
+                upper += m_cursors[m_order[i]].max_score;
+                if (upper > threshold()) {
+                    pivot = i;
+                    break;
+                }
+            }
+            if (pivot == n) {
+                break;
+            }
+            uint32_t docid = m_cursors[m_order[pivot]].doc();
+            while (pivot + 1 < n && m_cursors[m_order[pivot + 1]].doc() == docid) {
+                ++pivot;
+            }
+
+            double block_upper = 0;
+            for (size_t i = 0; i <= pivot; ++i) {
+                auto &c = m_cursors[m_order[i]];
+                shallow(c, docid);
+                block_upper += block_max(c);
+            }
+
+            if (block_upper > threshold()) {
+                if (m_cursors[m_order[0]].doc() == docid) {
+                    push(docid, score(docid));
+                    for (size_t i = 0; i <= pivot; ++i) {
+                        advance(m_cursors[m_order[i]]);
+                    }
+                } else {
+                    for (size_t i = 0; m_cursors[m_order[i]].doc() < docid; ++i) {
+                        next_geq(m_cursors[m_order[i]], docid);
+                    }
+                }
+                continue;
+            }
+
+            uint32_t next = pivot + 1 < n ? m_cursors[m_order[pivot + 1]].doc() : end_doc;
+            for (size_t i = 0; i <= pivot; ++i) {
+                uint32_t last = block_last(m_cursors[m_order[i]]);
+                next          = std::min(next, last == end_doc ? end_doc : last + 1);
+            }
+            next = std::max(next, docid + 1);
+            for (size_t i = 0; i <= pivot; ++i) {
+                next_geq(m_cursors[m_order[i]], next);
+            }
+        }
+    }
+
+   public:
+    bm25_retriever(InvertedIndex &inv_idx, const DocLens &doc_lens, const ScoreBounds &bounds)
+        : m_index(inv_idx), m_doc_lens(doc_lens), m_bounds(bounds) {
+        if (m_bounds.terms.size() != m_index.size()) {
+            std::cerr << "Score bounds of " << m_bounds.terms.size() << " lists for an index of "
+                      << m_index.size() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        for (size_t t = 0; t < m_index.size(); ++t) {
+            m_lists.insert(std::make_pair(m_index[t].term, t));
+        }
+    }
+
+    /* Documents fully scored since the retriever was made. */
+    size_t scored() const { return m_scored; }
+
+    /*
+     * The `k` best documents for the query `terms`, best first. A repeated term counts once with
+     * its query frequency, terms without a posting list are skipped.
+     */
+    std::vector<result> search(const std::vector<std::string> &terms, size_t k, algorithm a) {
+        m_k = k;
+        m_heap.clear();
+        std::vector<std::pair<size_t, int>> lists;
+        for (auto &&term : terms) {
+            auto it = m_lists.find(term);
+            if (it == m_lists.end()) {
+                continue;
+            }
+            auto seen = std::find_if(lists.begin(), lists.end(), [&](std::pair<size_t, int> &l) {
+                return l.first == it->second;
+            });
+            if (seen != lists.end()) {
+                ++seen->second;
+            } else {
+                lists.push_back(std::make_pair(it->second, 1));
+            }
+        }
+        // cursors keep their block buffers from one query to the next
+        m_cursors.resize(lists.size());
+        for (size_t i = 0; i < lists.size(); ++i) {
+            auto &c     = m_cursors[i];
+            c.postings  = &m_bounds.lists[lists[i].first];
+            c.bounds    = &m_bounds.terms[lists[i].first];
+            c.weight    = m_bounds.bm25.weight(lists[i].second, m_index[lists[i].first].size());
+            c.max_score = c.bounds->max_score * c.weight;
+            c.block     = 0;
+            decode(c, 0);
+        }
+
+        if (k > 0) {
+            if (a == maxscore) {
+                run_maxscore();
+            } else if (a == block_max_wand) {
+                run_block_max_wand();
+            } else {
+                run_exhaustive();
+            }
+        }
+        std::sort(m_heap.begin(), m_heap.end(), better);
+        return m_heap;
+    }
+};
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * A ranking cascade as written by `Cascade.py export`: a score update rule, an optional feature
+ * scaler and a list of stages, each pruning the candidates of a query before scoring the
+ * survivors with a linear model or with xgboost trees. Feature i is column i of the training data,
+ * feature id i + 1 in `feature-names.txt`.
+ *
+ * Scores follow `core.cascade.predict` up to floating point rounding, a tree stage of one class
+ * adding the xgboost `base_score` its tree dump leaves out. The upshift update is taken over the
+ * scores of one query rather than of all queries, which moves the scores of a query by a constant
+ * and leaves its ranking unchanged.
+ */
+class cascade_model {
+   public:
+    enum update_rule { additive, upshift, reset };
+
+    /* Survivors of a stage: all, the top `rank` or the top `beta` fraction of a query. */
+    struct prune_rule {
+        enum kind { none, rank, beta };
+        kind   type  = none;
+        double value = 0;
+
+        size_t cutoff(size_t n) const {
+            if (type == rank) {
+                return std::min(n, static_cast<size_t>(value));
+            }
+            if (type == beta) {
+                return std::min(n, static_cast<size_t>(std::ceil(n * value)));
+            }
+            return n;
+        }
+    };
+
+    /* A regression tree, a node with `feature` < 0 is a leaf. */
+    struct tree {
+        struct node {
+            int    feature   = -1;
+            float  threshold = 0;
+            size_t yes       = 0;
+            size_t no        = 0;
+            double leaf      = 0;
+        };
+        std::vector<node> nodes;
+
+        /* xgboost compares the features as float. */
+        double score(const double *x) const {
+            const node *n = &nodes[0];
+            while (n->feature >= 0) {
+                n = &nodes[static_cast<float>(x[n->feature]) < n->threshold ? n->yes : n->no];
+            }
+            return n->leaf;
+        }
+    };
+
+    struct stage {
+        prune_rule                             prune;
+        std::vector<std::pair<size_t, double>> weights;
+        double                                 intercept = 0;
+        // trees of class c are c, c + n_classes, ...
+        size_t                                 n_classes = 1;
+        // xgboost's global bias, added to the margin of a single class
+        double                                 base_score = 0.5;
+        std::vector<double>                    class_weights;
+        std::vector<tree>                      trees;
+        // features read by the stage, in increasing order
+        std::vector<size_t>                    features;
+
+        /* Score of a document from its dense, scaled feature row. */
+        double score(const double *x) const {
+            if (trees.empty()) {
+                double s = intercept;
+                for (auto &&w : weights) {
+                    s += x[w.first] * w.second;
+                }
+                return s;
+            }
+            std::vector<double> margin(n_classes, 0.0);
+            for (size_t i = 0; i < trees.size(); ++i) {
+                margin[i % n_classes] += trees[i].score(x);
+            }
+            if (n_classes == 1) {
+                return base_score + margin[0];
+            }
+            // expected label under the softmax of the class margins, the bias cancels out
+            double max = *std::max_element(margin.begin(), margin.end());
+            double sum = 0, s = 0;
+            for (size_t c = 0; c < n_classes; ++c) {
+                double p = std::exp(margin[c] - max);
+                sum += p;
+                s += p * class_weights[c];
+            }
+            return s / sum;
+        }
+    };
+
+   private:
+    size_t              m_features = 0;
+    update_rule         m_update   = additive;
+    double              m_gap      = 0;
+    std::vector<double> m_scale;
+    std::vector<stage>  m_stages;
+
+    static void fail(const std::string &path, const std::string &what) {
+        std::cerr << "Invalid cascade file " << path << ": " << what << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    static void expect(std::istream &in, const std::string &path, const std::string &keyword) {
+        std::string word;
+        if (!(in >> word) || word != keyword) {
+            fail(path, "expected '" + keyword + "'");
+        }
+    }
+
+    void read_trees(std::istream &in, const std::string &path, stage &s) {
+        size_t n_trees = 0;
+        in >> s.n_classes >> n_trees >> s.base_score;
+        if (s.n_classes > 1) {
+            expect(in, path, "class_weights");
+            s.class_weights.resize(s.n_classes);
+            for (auto &&w : s.class_weights) {
+                in >> w;
+            }
+        }
+        s.trees.resize(n_trees);
+        for (auto &&t : s.trees) {
+            size_t n_nodes = 0;
+            expect(in, path, "tree");
+            in >> n_nodes;
+            t.nodes.resize(n_nodes);
+            for (size_t k = 0; k < n_nodes; ++k) {
+                size_t      id;
+                std::string feature;
+                if (!(in >> id >> feature) || id >= n_nodes) {
+                    fail(path, "bad tree node");
+                }
+                auto &n = t.nodes[id];
+                if (feature == "leaf") {
+                    in >> n.leaf;
+                    continue;
+                }
+                n.feature = std::stoi(feature);
+                in >> n.threshold >> n.yes >> n.no;
+                if (n.feature >= static_cast<int>(m_features) || n.yes >= n_nodes ||
+                    n.no >= n_nodes) {
+                    fail(path, "bad tree node");
+                }
+                s.features.push_back(n.feature);
+            }
+        }
+    }
+
+   public:
+    explicit cascade_model(const std::string &path) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            std::cerr << "Could not open file: " << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        size_t      n_stages = 0;
+        std::string word;
+        expect(in, path, "cascade");
+        in >> n_stages >> m_features;
+
+        expect(in, path, "update");
+        in >> word;
+        if (word == "upshift" || word == "reset") {
+            m_update = word == "upshift" ? upshift : reset;
+            in >> m_gap;
+        } else if (word != "additive") {
+            fail(path, "unknown update " + word);
+        }
+
+        in >> word;
+        if (word == "scale") {
+            size_t n = 0;
+            in >> n;
+            m_scale.resize(n);
+            for (auto &&v : m_scale) {
+                in >> v;
+            }
+            in >> word;
+        }
+
+        m_stages.resize(n_stages);
+        for (auto &&s : m_stages) {
+            if (word != "stage") {
+                fail(path, "expected 'stage'");
+            }
+            expect(in, path, "prune");
+            in >> word;
+            if (word == "rank" || word == "beta") {
+                s.prune.type = word == "rank" ? prune_rule::rank : prune_rule::beta;
+                in >> s.prune.value;
+            } else if (word != "none") {
+                fail(path, "unknown prune " + word);
+            }
+
+            in >> word;
+            if (word == "linear") {
+                size_t n = 0;
+                in >> n >> s.intercept;
+                s.weights.resize(n);
+                for (auto &&w : s.weights) {
+                    in >> w.first >> w.second;
+                    if (w.first >= m_features) {
+                        fail(path, "bad feature " + std::to_string(w.first));
+                    }
+                    s.features.push_back(w.first);
+                }
+            } else if (word == "trees") {
+                read_trees(in, path, s);
+            } else {
+                fail(path, "unknown model " + word);
+            }
+            if (!in) {
+                fail(path, "truncated stage");
+            }
+            std::sort(s.features.begin(), s.features.end());
+            s.features.erase(std::unique(s.features.begin(), s.features.end()), s.features.end());
+            in >> word;
+        }
+    }
+
+    size_t                    features() const { return m_features; }
+    const std::vector<stage> &stages() const { return m_stages; }
+
+    /* Feature `f` as the model saw it in training. */
+    double scale(size_t f, double value) const {
+        return f < m_scale.size() && m_scale[f] != 0 ? value / m_scale[f] : value;
+    }
+
+    /*
+     * Survivors of stage `s` among the candidates `indexes` of one query, ranked by `preds`, in
+     * increasing index order. Tied candidates rank by decreasing index, the order of the
+     * reference `argsort(preds)[::-1]`, so a first stage over all-zero predictions keeps the last
+     * candidates as training did.
+     */
+    std::vector<size_t> prune(size_t                     s,
+                              const std::vector<double> &preds,
+                              std::vector<size_t>        indexes) const {
+        size_t n = m_stages[s].prune.cutoff(indexes.size());
+        if (n < indexes.size()) {
+            std::sort(indexes.begin(), indexes.end(), [&](size_t a, size_t b) {
+                return preds[a] > preds[b] || (preds[a] == preds[b] && a > b);
+            });
+            indexes.resize(n);
+            std::sort(indexes.begin(), indexes.end());
+        }
+        return indexes;
+    }
+
+    /* Applies the `scores` of the survivors `indexes` to the scores `preds` of one query. */
+    void update(std::vector<double> &      preds,
+                const std::vector<size_t> &indexes,
+                const std::vector<double> &scores) const {
+        if (m_update == additive) {
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                preds[indexes[i]] += scores[i];
+            }
+            return;
+        }
+        if (m_update == reset) {
+            std::fill(preds.begin(), preds.end(), 0.0);
+        }
+        if (indexes.empty()) {
+            return;
+        }
+        // survivors are moved above every other document by at least the gap
+        double max  = *std::max_element(preds.begin(), preds.end());
+        double min  = *std::min_element(scores.begin(), scores.end());
+        double diff = std::max(0.0, max + m_gap - min);
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            preds[indexes[i]] = scores[i] + diff;
+        }
+    }
+};
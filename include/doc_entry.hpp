@@ -1,14 +1,130 @@
 #pragma once
 
-#include <algorithm>
-#include <chrono>
+#include <cstdint>
 #include <iostream>
-#include <iterator>
-#include <map>
-#include <unordered_map>
-#include <utility>
+#include <string>
 #include <vector>
 
+/*
+ * The feature columns of a `doc_entry` in output order, as X(type, name), and the columns of each
+ * `batch_scorer` model as M(X, name), whose scopes `DOC_ENTRY_SCOPES` lists. A feature is added
+ * here only: its member, its place in `visit`, its column name and so its place in the CSV and
+ * .npy outputs all follow from this list, as do the models of `batch_scorer` and the columns they
+ * store. Counts are stored as integers, the outputs read every column as a double. The Gov2
+ * `feature-names.txt` lists them first, which `--feature-names` checks. The query-independent
+ * columns `StaticFeatures` keeps are listed in static_features.hpp.
+ */
+#define DOC_ENTRY_FEATURES(X, M)                                                                   \
+    X(double, pagerank)                                                                            \
+    /* Score from training trec run file */                                                        \
+    X(double, stage0_score)                                                                        \
+    /* BM25 Atire */                                                                               \
+    M(X, bm25_atire)                                                                               \
+    /* BM25 TREC3 k = 1.2, b = 0.75 */                                                             \
+    M(X, bm25_trec3)                                                                               \
+    /* BM25 TREC3 k = 2.0, b = 0.75 */                                                             \
+    M(X, bm25_trec3_kmax)                                                                          \
+    /* BM25 bigram unordered window score (sum of unigram scores) */                               \
+    X(double, bm25_bigram_u8)                                                                      \
+    /* BM25 score of bigram intervals in window (Lu, et al.) */                                    \
+    X(double, bm25_tp_dist_w100)                                                                   \
+    /* TP-Score */                                                                                 \
+    X(double, tpscore)                                                                             \
+    /* QL mu = 2500 */                                                                             \
+    M(X, lm_dir_2500)                                                                              \
+    /* QL mu = 1500 */                                                                             \
+    M(X, lm_dir_1500)                                                                              \
+    /* QL mu = 1000 */                                                                             \
+    M(X, lm_dir_1000)                                                                              \
+    /* tfidf */                                                                                    \
+    M(X, tfidf)                                                                                    \
+    /* Probability */                                                                              \
+    M(X, prob)                                                                                     \
+    /* DFR: Bose-Einstien */                                                                       \
+    M(X, be)                                                                                       \
+    /* DFR: DPH */                                                                                 \
+    M(X, dph)                                                                                      \
+    /* DFR: BB2 */                                                                                 \
+    M(X, dfr)                                                                                      \
+    /* Stream */                                                                                   \
+    X(double, stream_len)                                                                          \
+    X(double, stream_len_body)                                                                     \
+    X(double, stream_len_title)                                                                    \
+    X(double, stream_len_heading)                                                                  \
+    X(double, stream_len_inlink)                                                                   \
+    X(double, stream_len_a)                                                                        \
+    /* Stream sum normalised by tf */                                                              \
+    X(double, sum_stream_len)                                                                      \
+    X(double, sum_stream_len_body)                                                                 \
+    X(double, sum_stream_len_title)                                                                \
+    X(double, sum_stream_len_heading)                                                              \
+    X(double, sum_stream_len_inlink)                                                               \
+    X(double, sum_stream_len_a)                                                                    \
+    /* Stream min normalised by tf */                                                              \
+    X(double, min_stream_len)                                                                      \
+    X(double, min_stream_len_body)                                                                 \
+    X(double, min_stream_len_title)                                                                \
+    X(double, min_stream_len_heading)                                                              \
+    X(double, min_stream_len_inlink)                                                               \
+    X(double, min_stream_len_a)                                                                    \
+    /* Stream max normalised by tf */                                                              \
+    X(double, max_stream_len)                                                                      \
+    X(double, max_stream_len_body)                                                                 \
+    X(double, max_stream_len_title)                                                                \
+    X(double, max_stream_len_heading)                                                              \
+    X(double, max_stream_len_inlink)                                                               \
+    X(double, max_stream_len_a)                                                                    \
+    /* Stream mean normalised by tf */                                                             \
+    X(double, mean_stream_len)                                                                     \
+    X(double, mean_stream_len_body)                                                                \
+    X(double, mean_stream_len_title)                                                               \
+    X(double, mean_stream_len_heading)                                                             \
+    X(double, mean_stream_len_inlink)                                                              \
+    X(double, mean_stream_len_a)                                                                   \
+    /* Stream variance normalised by tf */                                                         \
+    X(double, variance_stream_len)                                                                 \
+    X(double, variance_stream_len_body)                                                            \
+    X(double, variance_stream_len_title)                                                           \
+    X(double, variance_stream_len_heading)                                                         \
+    X(double, variance_stream_len_inlink)                                                          \
+    X(double, variance_stream_len_a)                                                               \
+    /* The frequency of query terms within the <title> tag */                                      \
+    X(uint32_t, tag_title_qry_count)                                                               \
+    /* The frequency of query terms within the <heading> tag */                                    \
+    X(uint32_t, tag_heading_qry_count)                                                             \
+    /* The frequency of query terms within the <mainbody> tag */                                   \
+    X(uint32_t, tag_mainbody_qry_count)                                                            \
+    /* The frequency of query terms within the inlinks */                                          \
+    X(uint32_t, tag_inlink_qry_count)                                                              \
+    /* The number of times the <title> tag appears in the document */                              \
+    X(int, tag_title_count)                                                                        \
+    /* The number of <heading> tags in the document, Indri's heading covers h1-h4 */               \
+    X(int, tag_heading_count)                                                                      \
+    /* The number of inlinks in the document */                                                    \
+    X(int, tag_inlink_count)                                                                       \
+    /* The number of times the <applet> tag appears in the document */                             \
+    X(int, tag_applet_count)                                                                       \
+    /* The number of times the <object> tag appears in the document */                             \
+    X(int, tag_object_count)                                                                       \
+    /* The number of times the <embed> tag appears in the document */                              \
+    X(int, tag_embed_count)                                                                        \
+    /* Number of slashes in URL */                                                                 \
+    X(int, url_slash_count)                                                                        \
+    /* URL length */                                                                               \
+    X(uint32_t, url_length)
+
+/* The columns of model `name`: the whole document, then each scored field of `query_doc_view`. */
+#define DOC_ENTRY_SCOPES(X, name)                                                                  \
+    X(double, name)                                                                                \
+    X(double, name##_body)                                                                         \
+    X(double, name##_title)                                                                        \
+    X(double, name##_heading)                                                                      \
+    X(double, name##_inlink)                                                                       \
+    X(double, name##_a)
+
+/* Every column as X(type, name). */
+#define DOC_ENTRY_COLUMNS(X) DOC_ENTRY_FEATURES(X, DOC_ENTRY_SCOPES)
+
 struct doc_entry {
 
     // doc id for convenience
@@ -16,292 +132,35 @@ struct doc_entry {
 
     size_t length = 0;
 
-    double pagerank = 0;
-    // Score from training trec run file
-    double stage0_score = 0;
-    // BM25 Atire
-    double bm25_atire         = 0;
-    double bm25_atire_body    = 0;
-    double bm25_atire_title   = 0;
-    double bm25_atire_heading = 0;
-    double bm25_atire_inlink  = 0;
-    double bm25_atire_a       = 0;
-    // BM25 TREC3 k = 1.2, b = 0.75
-    double bm25_trec3         = 0;
-    double bm25_trec3_body    = 0;
-    double bm25_trec3_title   = 0;
-    double bm25_trec3_heading = 0;
-    double bm25_trec3_inlink  = 0;
-    double bm25_trec3_a       = 0;
-    // BM25 TREC3 k = 2.0, b = 0.75
-    double bm25_trec3_kmax         = 0;
-    double bm25_trec3_kmax_body    = 0;
-    double bm25_trec3_kmax_title   = 0;
-    double bm25_trec3_kmax_heading = 0;
-    double bm25_trec3_kmax_inlink  = 0;
-    double bm25_trec3_kmax_a       = 0;
-    // QL mu = 2500
-    double lm_dir_2500         = 0;
-    double lm_dir_2500_body    = 0;
-    double lm_dir_2500_title   = 0;
-    double lm_dir_2500_heading = 0;
-    double lm_dir_2500_inlink  = 0;
-    double lm_dir_2500_a       = 0;
-    // QL mu = 1500
-    double lm_dir_1500         = 0;
-    double lm_dir_1500_body    = 0;
-    double lm_dir_1500_title   = 0;
-    double lm_dir_1500_heading = 0;
-    double lm_dir_1500_inlink  = 0;
-    double lm_dir_1500_a       = 0;
-    // QL mu = 1000
-    double lm_dir_1000         = 0;
-    double lm_dir_1000_body    = 0;
-    double lm_dir_1000_title   = 0;
-    double lm_dir_1000_heading = 0;
-    double lm_dir_1000_inlink  = 0;
-    double lm_dir_1000_a       = 0;
-    // tfidf
-    double tfidf         = 0;
-    double tfidf_body    = 0;
-    double tfidf_title   = 0;
-    double tfidf_heading = 0;
-    double tfidf_inlink  = 0;
-    double tfidf_a       = 0;
-    // Probability
-    double prob         = 0;
-    double prob_body    = 0;
-    double prob_title   = 0;
-    double prob_heading = 0;
-    double prob_inlink  = 0;
-    double prob_a       = 0;
-    // DFR: Bose-Einstien
-    double be         = 0;
-    double be_body    = 0;
-    double be_title   = 0;
-    double be_heading = 0;
-    double be_inlink  = 0;
-    double be_a       = 0;
-    // DFR: DPH
-    double dph         = 0;
-    double dph_body    = 0;
-    double dph_title   = 0;
-    double dph_heading = 0;
-    double dph_inlink  = 0;
-    double dph_a       = 0;
-    // DFR: BB2
-    double dfr         = 0;
-    double dfr_body    = 0;
-    double dfr_title   = 0;
-    double dfr_heading = 0;
-    double dfr_inlink  = 0;
-    double dfr_a       = 0;
-    // Stream
-    double stream_len         = 0;
-    double stream_len_body    = 0;
-    double stream_len_title   = 0;
-    double stream_len_heading = 0;
-    double stream_len_inlink  = 0;
-    double stream_len_a       = 0;
-    // Stream sum normalised by tf
-    double sum_stream_len         = 0;
-    double sum_stream_len_body    = 0;
-    double sum_stream_len_title   = 0;
-    double sum_stream_len_heading = 0;
-    double sum_stream_len_inlink  = 0;
-    double sum_stream_len_a       = 0;
-    // Stream min normalised by tf
-    double min_stream_len         = 0;
-    double min_stream_len_body    = 0;
-    double min_stream_len_title   = 0;
-    double min_stream_len_heading = 0;
-    double min_stream_len_inlink  = 0;
-    double min_stream_len_a       = 0;
-    // Stream max normalised by tf
-    double max_stream_len         = 0;
-    double max_stream_len_body    = 0;
-    double max_stream_len_title   = 0;
-    double max_stream_len_heading = 0;
-    double max_stream_len_inlink  = 0;
-    double max_stream_len_a       = 0;
-    // Stream mean normalised by tf
-    double mean_stream_len         = 0;
-    double mean_stream_len_body    = 0;
-    double mean_stream_len_title   = 0;
-    double mean_stream_len_heading = 0;
-    double mean_stream_len_inlink  = 0;
-    double mean_stream_len_a       = 0;
-    // Stream variance normalised by tf
-    double variance_stream_len         = 0;
-    double variance_stream_len_body    = 0;
-    double variance_stream_len_title   = 0;
-    double variance_stream_len_heading = 0;
-    double variance_stream_len_inlink  = 0;
-    double variance_stream_len_a       = 0;
-
-    // TP-Score
-    double tpscore = 0;
-
-    // BM25 bigram unordered window score (sum of unigram scores)
-    double bm25_bigram_u8 = 0;
-    // BM25 score of bigram intervals in window (Lu, et al.)
-    double bm25_tp_dist_w100 = 0;
-
-    // The frequency of query terms within the <title> tag
-    size_t tag_title_qry_count = 0;
-    // The frequency of query terms within the <heading> tag
-    size_t tag_heading_qry_count = 0;
-    // The frequency of query terms within the <mainbody> tag
-    size_t tag_mainbody_qry_count = 0;
-    // The frequency of query terms within the inlinks
-    size_t tag_inlink_qry_count = 0;
-
-    // The number of times the <title> tag appears in the document
-    int tag_title_count = 0;
-    // The number of times the <heading> tag appears in the document
-    int tag_heading_count = 0; // Indri heading field includes tags h1-h4
-    // The number of inlinks in the document
-    int tag_inlink_count = 0;
-    // The number of times the <applet> tag appears in the document
-    int tag_applet_count = 0;
-    // The number of times the <object> tag appears in the document
-    int tag_object_count = 0;
-    // The number of times the <embed> tag appears in the document
-    int tag_embed_count = 0;
-
-    // Number of slashes in URL
-    int url_slash_count = 0;
-    // URL length
-    size_t url_length = 0;
+#define DOC_ENTRY_MEMBER(type, name) type name = 0;
+    DOC_ENTRY_COLUMNS(DOC_ENTRY_MEMBER)
+#undef DOC_ENTRY_MEMBER
 
     doc_entry(int i, double pr)
         : id(i), pagerank(pr) {}
 
+    /* Calls `f(name, value)` for every feature, in the order of the output columns. */
+    template <class F>
+    void visit(F &&f) const {
+#define DOC_ENTRY_VISIT(type, name) f(#name, static_cast<double>(name));
+        DOC_ENTRY_COLUMNS(DOC_ENTRY_VISIT)
+#undef DOC_ENTRY_VISIT
+    }
+
+    /* Names of the feature columns. */
+    static const std::vector<std::string> &names() {
+        static const std::vector<std::string> names = {
+#define DOC_ENTRY_NAME(type, name) #name,
+            DOC_ENTRY_COLUMNS(DOC_ENTRY_NAME)
+#undef DOC_ENTRY_NAME
+        };
+        return names;
+    }
+
     friend std::ostream &operator<<(std::ostream &os, const doc_entry &de);
 };
 
 std::ostream &operator<<(std::ostream &os, const doc_entry &de) {
-    os << "," << de.pagerank;
-    os << "," << de.stage0_score;
-    os << "," << de.bm25_atire;
-    os << "," << de.bm25_atire_body;
-    os << "," << de.bm25_atire_title;
-    os << "," << de.bm25_atire_heading;
-    os << "," << de.bm25_atire_inlink;
-    os << "," << de.bm25_atire_a;
-    os << "," << de.bm25_trec3;
-    os << "," << de.bm25_trec3_body;
-    os << "," << de.bm25_trec3_title;
-    os << "," << de.bm25_trec3_heading;
-    os << "," << de.bm25_trec3_inlink;
-    os << "," << de.bm25_trec3_a;
-    os << "," << de.bm25_trec3_kmax;
-    os << "," << de.bm25_trec3_kmax_body;
-    os << "," << de.bm25_trec3_kmax_title;
-    os << "," << de.bm25_trec3_kmax_heading;
-    os << "," << de.bm25_trec3_kmax_inlink;
-    os << "," << de.bm25_trec3_kmax_a;
-    os << "," << de.bm25_bigram_u8;
-    os << "," << de.bm25_tp_dist_w100;
-    os << "," << de.tpscore;
-    os << "," << de.lm_dir_2500;
-    os << "," << de.lm_dir_2500_body;
-    os << "," << de.lm_dir_2500_title;
-    os << "," << de.lm_dir_2500_heading;
-    os << "," << de.lm_dir_2500_inlink;
-    os << "," << de.lm_dir_2500_a;
-    os << "," << de.lm_dir_1500;
-    os << "," << de.lm_dir_1500_body;
-    os << "," << de.lm_dir_1500_title;
-    os << "," << de.lm_dir_1500_heading;
-    os << "," << de.lm_dir_1500_inlink;
-    os << "," << de.lm_dir_1500_a;
-    os << "," << de.lm_dir_1000;
-    os << "," << de.lm_dir_1000_body;
-    os << "," << de.lm_dir_1000_title;
-    os << "," << de.lm_dir_1000_heading;
-    os << "," << de.lm_dir_1000_inlink;
-    os << "," << de.lm_dir_1000_a;
-    os << "," << de.tfidf;
-    os << "," << de.tfidf_body;
-    os << "," << de.tfidf_title;
-    os << "," << de.tfidf_heading;
-    os << "," << de.tfidf_inlink;
-    os << "," << de.tfidf_a;
-    os << "," << de.prob;
-    os << "," << de.prob_body;
-    os << "," << de.prob_title;
-    os << "," << de.prob_heading;
-    os << "," << de.prob_inlink;
-    os << "," << de.prob_a;
-    os << "," << de.be;
-    os << "," << de.be_body;
-    os << "," << de.be_title;
-    os << "," << de.be_heading;
-    os << "," << de.be_inlink;
-    os << "," << de.be_a;
-    os << "," << de.dph;
-    os << "," << de.dph_body;
-    os << "," << de.dph_title;
-    os << "," << de.dph_heading;
-    os << "," << de.dph_inlink;
-    os << "," << de.dph_a;
-    os << "," << de.dfr;
-    os << "," << de.dfr_body;
-    os << "," << de.dfr_title;
-    os << "," << de.dfr_heading;
-    os << "," << de.dfr_inlink;
-    os << "," << de.dfr_a;
-    os << "," << de.stream_len;
-    os << "," << de.stream_len_body;
-    os << "," << de.stream_len_title;
-    os << "," << de.stream_len_heading;
-    os << "," << de.stream_len_inlink;
-    os << "," << de.stream_len_a;
-    os << "," << de.sum_stream_len;
-    os << "," << de.sum_stream_len_body;
-    os << "," << de.sum_stream_len_title;
-    os << "," << de.sum_stream_len_heading;
-    os << "," << de.sum_stream_len_inlink;
-    os << "," << de.sum_stream_len_a;
-    os << "," << de.min_stream_len;
-    os << "," << de.min_stream_len_body;
-    os << "," << de.min_stream_len_title;
-    os << "," << de.min_stream_len_heading;
-    os << "," << de.min_stream_len_inlink;
-    os << "," << de.min_stream_len_a;
-    os << "," << de.max_stream_len;
-    os << "," << de.max_stream_len_body;
-    os << "," << de.max_stream_len_title;
-    os << "," << de.max_stream_len_heading;
-    os << "," << de.max_stream_len_inlink;
-    os << "," << de.max_stream_len_a;
-    os << "," << de.mean_stream_len;
-    os << "," << de.mean_stream_len_body;
-    os << "," << de.mean_stream_len_title;
-    os << "," << de.mean_stream_len_heading;
-    os << "," << de.mean_stream_len_inlink;
-    os << "," << de.mean_stream_len_a;
-    os << "," << de.variance_stream_len;
-    os << "," << de.variance_stream_len_body;
-    os << "," << de.variance_stream_len_title;
-    os << "," << de.variance_stream_len_heading;
-    os << "," << de.variance_stream_len_inlink;
-    os << "," << de.variance_stream_len_a;
-
-    os << "," << static_cast<double>(de.tag_title_qry_count);
-    os << "," << static_cast<double>(de.tag_heading_qry_count);
-    os << "," << static_cast<double>(de.tag_mainbody_qry_count);
-    os << "," << static_cast<double>(de.tag_inlink_qry_count);
-
-    os << "," << static_cast<double>(de.tag_title_count);
-    os << "," << static_cast<double>(de.tag_heading_count);
-    os << "," << static_cast<double>(de.tag_inlink_count);
-    os << "," << static_cast<double>(de.tag_applet_count);
-    os << "," << static_cast<double>(de.tag_object_count);
-    os << "," << static_cast<double>(de.tag_embed_count);
-
-    os << "," << static_cast<double>(de.url_slash_count);
-    os << "," << static_cast<double>(de.url_length);
+    de.visit([&](const char *, double value) { os << "," << value; });
     return os;
 }
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Docno to Indri document id table, memory mapped from the file written by `create_forward_index`
+ * so it resolves docnos without opening the Indri repository.
+ *
+ * The file is a header of five 64-bit words (magic, docs, docno width, slots, 0), the docno of each
+ * id padded with NULs to the width, id 0 unused, then an open addressing hash table of `slots`
+ * 32-bit ids, 0 marking an empty slot. Values are in host byte order.
+ */
+class docno_map {
+    static constexpr uint64_t magic = 0x50414d4f4e434f44ULL; // "DOCNOMAP"
+
+    const char *    m_data   = nullptr;
+    size_t          m_size   = 0;
+    uint64_t        m_docs   = 0;
+    uint64_t        m_width  = 0;
+    uint64_t        m_slots  = 0;
+    const char *    m_docnos = nullptr;
+    const uint32_t *m_table  = nullptr;
+
+    static uint64_t hash(const char *s, size_t len) {
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < len; ++i) {
+            h = (h ^ static_cast<unsigned char>(s[i])) * 1099511628211ULL;
+        }
+        return h;
+    }
+
+    static uint64_t docnos_size(uint64_t docs, uint64_t width) {
+        return ((docs + 1) * width + 7) / 8 * 8;
+    }
+
+    bool matches(uint32_t id, const std::string &docno) const {
+        const char *stored = m_docnos + id * m_width;
+        return docno.size() <= m_width && std::memcmp(stored, docno.data(), docno.size()) == 0 &&
+               (docno.size() == m_width || stored[docno.size()] == '\0');
+    }
+
+   public:
+    explicit docno_map(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Could not open file: " << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            std::cerr << "Could not stat file: " << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_size = st.st_size;
+        void *data = m_size ? mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+        const uint64_t *header = static_cast<const uint64_t *>(data);
+        if (data == MAP_FAILED || m_size < 5 * sizeof(uint64_t) || header[0] != magic) {
+            std::cerr << "Not a docno map: " << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_data   = static_cast<const char *>(data);
+        m_docs   = header[1];
+        m_width  = header[2];
+        m_slots  = header[3];
+        m_docnos = m_data + 5 * sizeof(uint64_t);
+        m_table  = reinterpret_cast<const uint32_t *>(m_docnos + docnos_size(m_docs, m_width));
+        if (m_size != 5 * sizeof(uint64_t) + docnos_size(m_docs, m_width) +
+                          m_slots * sizeof(uint32_t)) {
+            std::cerr << "Truncated docno map: " << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    ~docno_map() { munmap(const_cast<char *>(m_data), m_size); }
+
+    docno_map(const docno_map &) = delete;
+    docno_map &operator=(const docno_map &) = delete;
+
+    uint64_t size() const { return m_docs; }
+
+    /* Document id of `docno`, 0 if there is none. */
+    uint32_t find(const std::string &docno) const {
+        uint64_t s = hash(docno.data(), docno.size()) & (m_slots - 1);
+        while (m_table[s] != 0 && !matches(m_table[s], docno)) {
+            s = (s + 1) & (m_slots - 1);
+        }
+        return m_table[s];
+    }
+
+    /* Docno of document `id`, empty if it has none. */
+    std::string docno(uint32_t id) const {
+        if (id == 0 || id > m_docs) {
+            return std::string();
+        }
+        const char *stored = m_docnos + id * m_width;
+        return std::string(stored, std::find(stored, stored + m_width, '\0'));
+    }
+
+    /* Writes the map of `docnos`, the docno of id d at index d, ids without a docno left empty. */
+    static void write(const std::string &path, const std::vector<std::string> &docnos) {
+        uint64_t docs  = docnos.empty() ? 0 : docnos.size() - 1;
+        uint64_t width = 1;
+        for (auto &&docno : docnos) {
+            width = std::max<uint64_t>(width, docno.size());
+        }
+        // at most half full, so a miss ends at an empty slot after a few probes
+        uint64_t slots = 2;
+        while (slots < 2 * docs) {
+            slots *= 2;
+        }
+
+        std::vector<char>     names(docnos_size(docs, width), '\0');
+        std::vector<uint32_t> table(slots, 0);
+        for (uint64_t id = 1; id <= docs; ++id) {
+            auto &docno = docnos[id];
+            if (docno.empty()) {
+                continue;
+            }
+            std::memcpy(&names[id * width], docno.data(), docno.size());
+            uint64_t s = hash(docno.data(), docno.size()) & (slots - 1);
+            while (table[s] != 0) {
+                s = (s + 1) & (slots - 1);
+            }
+            table[s] = id;
+        }
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out.is_open()) {
+            std::cerr << "Could not open file: " << path << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        uint64_t header[5] = {magic, docs, width, slots, 0};
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        out.write(names.data(), names.size());
+        out.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(uint32_t));
+    }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "indri/Repository.hpp"
+
+#include "docno_map.hpp"
+#include "field_id.hpp"
+#include "query_environment_adapter.hpp"
+
+/**
+ * Document ids of docnos and ids of index fields, read from the docno map and the field manifest
+ * of `create_forward_index` when given, so the Indri repository is never opened, and from the
+ * repository otherwise.
+ */
+class docno_resolver {
+    query_environment             m_indri_env;
+    query_environment_adapter     m_qry_env;
+    indri::collection::Repository m_repo;
+    std::unique_ptr<docno_map>    m_docnos;
+    FieldIdMap                    m_fields;
+
+   public:
+    docno_resolver(const std::string &repo_path,
+                   const std::string &docno_map_file,
+                   const std::string &fields_file)
+        : m_qry_env(&m_indri_env) {
+        if (docno_map_file.empty() != fields_file.empty()) {
+            std::cerr << "Running without Indri needs both --docno-map and --fields" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (!docno_map_file.empty()) {
+            m_docnos.reset(new docno_map(docno_map_file));
+            m_fields = read_field_manifest(fields_file);
+        } else {
+            m_qry_env.add_index(repo_path);
+            m_repo.openRead(repo_path);
+        }
+    }
+
+    /* Id of an index field, below 1 if it is not indexed. */
+    int field(const std::string &name) {
+        if (m_docnos) {
+            return find_field_id(m_fields, name);
+        }
+        return (*m_repo.indexes())[0]->field(name);
+    }
+
+    std::vector<docid_t> document_ids(const std::vector<std::string> &docnos) {
+        if (!m_docnos) {
+            return m_qry_env.document_ids_from_metadata("docno", docnos);
+        }
+        std::vector<docid_t> ids;
+        ids.reserve(docnos.size());
+        for (auto &&docno : docnos) {
+            // an unknown docno is document 0, as Indri resolves it
+            uint32_t id = m_docnos->find(docno);
+            if (id == 0) {
+                std::cerr << "Unknown docno: " << docno << std::endl;
+            }
+            ids.push_back(id);
+        }
+        return ids;
+    }
+};
@@ -0,0 +1,423 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "doc_entry.hpp"
+#include "feature_profile.hpp"
+#include "field_id.hpp"
+#include "forward_index.hpp"
+#include "lexicon.hpp"
+#include "query_train_file.hpp"
+#include "static_features.hpp"
+
+#include "features/features.hpp"
+
+/* The extractors a run needs, by default all of them. */
+struct pipeline {
+    std::vector<bool> models    = std::vector<bool>(batch_scorer::model_count, true);
+    bool              stream    = true;
+    bool              tags      = true;
+    bool              proximity = true;
+    bool              tpscore   = true;
+
+    bool per_document() const { return stream || tags || proximity || tpscore; }
+};
+
+/* Extractors as timed by `feature_profile`, model m of `batch_scorer` is `model_extractor + m`. */
+enum extractor_id : size_t {
+    index_extractor,
+    gather_extractor,
+    stream_extractor,
+    tags_extractor,
+    proximity_extractor,
+    tpscore_extractor,
+    model_extractor
+};
+constexpr size_t extractor_count = model_extractor + batch_scorer::model_count;
+
+inline std::vector<std::string> extractor_names() {
+    std::vector<std::string> names = {"index", "gather", "stream", "tags", "proximity", "tpscore"};
+    for (size_t m = 0; m < batch_scorer::model_count; ++m) {
+        names.push_back(batch_scorer::column_name(m, 0));
+    }
+    return names;
+}
+
+/*
+ * Version of the values of each extractor, so the columns a `feature_store` kept from an earlier
+ * version are computed again. A change that alters any value an extractor writes, a formula, a
+ * default parameter or a fix such as those listed in the Gov2 README, raises its version in the
+ * same commit; sweep columns follow the extractor of their family. A change leaving every value
+ * as it was, such as a faster loop, keeps it.
+ */
+inline uint32_t extractor_version(size_t extractor) {
+    static const std::array<uint32_t, extractor_count> versions = {{
+        1, // index
+        1, // gather
+        1, // stream
+        1, // tags
+        1, // proximity
+        1, // tpscore
+        1, // bm25_atire
+        1, // bm25_trec3
+        1, // bm25_trec3_kmax
+        1, // lm_dir_2500
+        1, // lm_dir_1500
+        1, // lm_dir_1000
+        1, // tfidf
+        1, // prob
+        1, // be
+        1, // dph
+        1  // dfr
+    }};
+    return versions[extractor];
+}
+
+/*
+ * The extractor computing the feature column `name`, spelled as in `feature-names.txt`. Sweep
+ * columns belong to the extractor of their family, BM25 and LM ones to its first model. Columns
+ * read from the index and the run, and names this tool does not produce, are `index_extractor`.
+ */
+inline size_t extractor_of(const std::string &name) {
+    for (size_t m = 0; m < batch_scorer::model_count; ++m) {
+        for (size_t s = 0; s < batch_scorer::scope_count; ++s) {
+            if (name == batch_scorer::column_name(m, s)) {
+                return model_extractor + m;
+            }
+        }
+    }
+    if (name.find("stream_len") != std::string::npos) {
+        return stream_extractor;
+    } else if (name.compare(0, 4, "tag_") == 0) {
+        return tags_extractor;
+    } else if (name.compare(0, 12, "bm25_bigram_") == 0 ||
+               name.compare(0, 13, "bm25_tp_dist_") == 0) {
+        return proximity_extractor;
+    } else if (name.compare(0, 8, "bm25_k1_") == 0) {
+        return model_extractor + batch_scorer::bm25_atire;
+    } else if (name.compare(0, 7, "lm_dir_") == 0) {
+        return model_extractor + batch_scorer::lm_dir_2500;
+    } else if (name == "tpscore") {
+        return tpscore_extractor;
+    }
+    return index_extractor;
+}
+
+/*
+ * The extractors computing the feature columns `names`. Selection is per extractor: one name
+ * runs its whole extractor, which fills its sibling columns too. Names of features this tool does
+ * not produce, such as the pre-retrieval ones, are ignored.
+ */
+inline pipeline select_pipeline(const std::vector<std::string> &names) {
+    pipeline p;
+    p.models.assign(batch_scorer::model_count, false);
+    p.stream = p.tags = p.proximity = p.tpscore = false;
+    for (auto &&name : names) {
+        size_t e = extractor_of(name);
+        if (e >= model_extractor) {
+            p.models[e - model_extractor] = true;
+        }
+        p.stream    = p.stream || e == stream_extractor;
+        p.tags      = p.tags || e == tags_extractor;
+        p.proximity = p.proximity || e == proximity_extractor;
+        p.tpscore   = p.tpscore || e == tpscore_extractor;
+    }
+    return p;
+}
+
+/*
+ * Cost of the feature columns `names` in cycles per document. A column costs its whole extractor,
+ * which computes it along with the other columns of the extractor, plus an even share of the
+ * gather every extractor but the index reads. Fused models share their family's cycles evenly.
+ */
+inline std::vector<double> feature_costs(const feature_profile &         profile,
+                                         const std::vector<std::string> &names) {
+    size_t readers = 0;
+    for (size_t e = 0; e < extractor_count; ++e) {
+        if (e != index_extractor && e != gather_extractor && profile.mean(e) > 0) {
+            ++readers;
+        }
+    }
+    double gather = readers ? profile.mean(gather_extractor) / readers : 0.0;
+
+    std::vector<double> costs;
+    for (auto &&name : names) {
+        size_t e = extractor_of(name);
+        costs.push_back(profile.mean(e) + (e == index_extractor ? 0.0 : gather));
+    }
+    return costs;
+}
+
+/* One feature name per line, the last word of a line, so `feature-names.txt` can be used as is. */
+inline std::vector<std::string> read_feature_names(const std::string &file) {
+    std::ifstream ifs(file);
+    if (!ifs.is_open()) {
+        std::cerr << "Could not open file: " << file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::vector<std::string> names;
+    std::string              line;
+    while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        std::string        word, name;
+        while (iss >> word) {
+            name = word;
+        }
+        if (!name.empty()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+/*
+ * Exits unless `names` starts with the `doc_entry` columns in output order, so a names file kept
+ * next to the features, such as `feature-names.txt`, cannot drift from the schema.
+ */
+inline void check_feature_names(const std::vector<std::string> &names) {
+    auto &columns = doc_entry::names();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i == names.size() || names[i] != columns[i]) {
+            std::cerr << "Feature " << i + 1 << " is " << columns[i] << ", not "
+                      << (i < names.size() ? names[i] : "missing") << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/* A `doc_entry` with the features read straight from the forward index and the run. */
+inline doc_entry document_entry(int docid, const Document &doc_idx, double stage0_score) {
+    doc_entry entry(docid, doc_idx.pagerank());
+    entry.length = doc_idx.length();
+
+    // set url_slash_count as feature for training
+    entry.url_slash_count = doc_idx.url_slash_count();
+    entry.url_length      = doc_idx.url_length();
+
+    // set original run score as a feature for training
+    entry.stage0_score = stage0_score;
+    return entry;
+}
+
+/*
+ * Extractors of one thread. The additive models score a chunk at a time from its columnar batch,
+ * the remaining extractors keep per-document state and read the views gathered for the batch.
+ * Only the extractors of the pipeline run, the columns of the others stay zero.
+ *
+ * Every table is kept from one batch to the next, so once `reserve` has made room for the largest
+ * batch, or after the first batches have grown them, a document is scored without allocating.
+ *
+ * With a `StaticFeatures` table, the query-independent columns and the BM25 normalisations are
+ * copied from the row of the document.
+ */
+struct extractor_set {
+    query_doc_view              view;
+    // views of the largest batch so far, the first `batch_docs` are those of the last one
+    std::vector<query_doc_view> views;
+    size_t                      batch_docs = 0;
+    query_doc_batch             batch;
+    feature_matrix              matrix;
+    batch_scorer                scorer;
+    document_features           features;
+    doc_proximity_feature       prox_feature;
+    doc_stream_feature          f_stream;
+    doc_tpscore_feature         f_tpscore;
+    pipeline                    active;
+    // proximity sweep columns of the last batch, a row per document
+    std::vector<double>         prox_sweep;
+    // cycles of the extractors when set, owned by the caller
+    feature_profile *           profile = nullptr;
+    // static columns of the documents when set, owned by the caller
+    const StaticFeatures *      statics = nullptr;
+
+   private:
+    /* Times the families of the batch scorer, a family's cycles are split among its models. */
+    struct batch_timer {
+        extractor_set &set;
+
+        template <class F>
+        void operator()(const size_t *models, size_t count, F &&run) {
+            uint64_t start = read_cycles();
+            run();
+            double cycles = double(read_cycles() - start) / count;
+            for (size_t i = 0; i < count; ++i) {
+                // sweep settings have no column of their own
+                if (models[i] < batch_scorer::model_count) {
+                    set.add_batch(model_extractor + models[i], cycles);
+                }
+            }
+        }
+    };
+
+    size_t terms(size_t k) const { return k < batch_docs ? views[k].terms().size() : 0; }
+
+    /* Spreads the `cycles` of an extractor on the last batch evenly over its documents. */
+    void add_batch(size_t extractor, double cycles) {
+        double share = cycles / std::max<size_t>(batch_docs, 1);
+        for (size_t k = 0; k < batch_docs; ++k) {
+            profile->add(extractor, terms(k), views[k].length(), share);
+        }
+    }
+
+    template <class F>
+    void timed(size_t extractor, size_t k, F &&f) {
+        if (!profile) {
+            f();
+            return;
+        }
+        uint64_t start = read_cycles();
+        f();
+        profile->add(extractor, terms(k), views[k].length(), read_cycles() - start);
+    }
+
+   public:
+    extractor_set(Lexicon &                                     lexicon,
+                  const FieldIdMap &                            field_id_map,
+                  const std::vector<batch_scorer::bm25_params> &bm25_sweep,
+                  const std::vector<double> &                   lm_sweep,
+                  const pipeline &                              p,
+                  const std::vector<proximity_window> &         window_sweep  = {},
+                  const std::vector<int> &                      tp_dist_sweep = {})
+        : view(field_id_map),
+          scorer(lexicon, bm25_sweep, lm_sweep),
+          prox_feature(lexicon, window_sweep, tp_dist_sweep),
+          f_tpscore(lexicon),
+          active(p) {
+        scorer.select(active.models);
+    }
+
+    /* Room for batches of up to `docs` documents of queries of up to `terms` terms. */
+    void reserve(size_t docs, size_t terms) {
+        if (views.size() < docs) {
+            views.resize(docs, view);
+        }
+        for (auto &&v : views) {
+            v.reserve(terms);
+        }
+        batch.reserve(docs, terms, statics ? StaticFeatures::norm_columns : 0);
+        scorer.reserve(matrix, docs);
+        prox_feature.reserve(terms);
+        prox_sweep.reserve(docs * prox_feature.sweep_names().size());
+        f_tpscore.reserve(terms);
+    }
+
+    /* Names of the sweep columns, those of the batch scorer first. */
+    std::vector<std::string> sweep_names() const {
+        auto names = scorer.sweep_names();
+        auto prox  = prox_feature.sweep_names();
+        names.insert(names.end(), prox.begin(), prox.end());
+        return names;
+    }
+
+    /* Scores `docs`, the forward index documents of ids `docids`, for `qry`. */
+    void score_batch(const query_train &                   qry,
+                     const std::vector<const Document *> &docs,
+                     const std::vector<int> &              docids) {
+        bool batched = scorer.active();
+        bool swept   = !prox_feature.sweep_names().empty();
+        if (!batched && !active.per_document() && !swept) {
+            return;
+        }
+        prox_sweep.assign(docs.size() * prox_feature.sweep_names().size(), 0.0);
+        uint64_t start = profile ? read_cycles() : 0;
+        // term weights only depend on the query, the extractors compute them once per batch
+        if (active.proximity || swept) {
+            prox_feature.prepare(qry);
+        }
+        if (active.tpscore) {
+            f_tpscore.prepare(qry);
+        }
+        if (views.size() < docs.size()) {
+            views.resize(docs.size(), view);
+        }
+        batch_docs = docs.size();
+        batch.clear();
+        for (size_t k = 0; k < docs.size(); ++k) {
+            views[k].gather(qry, *docs[k]);
+            if (batched && statics) {
+                batch.add(views[k], statics->norms(docids[k]), StaticFeatures::norm_columns);
+            } else if (batched) {
+                batch.add(views[k]);
+            }
+        }
+        if (profile) {
+            add_batch(gather_extractor, read_cycles() - start);
+        }
+        if (batched && profile) {
+            batch_timer timed{*this};
+            scorer.score(batch, matrix, timed);
+        } else if (batched) {
+            scorer.score(batch, matrix);
+        }
+    }
+
+    /* Document `k` of the last scored batch. */
+    void compute(size_t k, doc_entry &doc) {
+        if (scorer.active()) {
+            batch_scorer::store(matrix, k, doc);
+        }
+        // the static columns were copied by `entry`
+        if (active.stream && statics) {
+            timed(stream_extractor, k, [&] { f_stream.normalised(doc, views[k]); });
+        } else if (active.stream) {
+            timed(stream_extractor, k, [&] { f_stream.compute(doc, views[k]); });
+        }
+        if (active.tags && statics) {
+            timed(tags_extractor, k, [&] { features.qry_counts(doc, views[k]); });
+        } else if (active.tags) {
+            timed(tags_extractor, k, [&] { features.compute(doc, views[k]); });
+        }
+        // the proximity sweep is computed whatever the pipeline
+        size_t swept = prox_feature.sweep_names().size();
+        if (active.proximity || swept) {
+            timed(proximity_extractor, k, [&] { prox_feature.evaluate(views[k]); });
+            if (active.proximity) {
+                prox_feature.store(doc);
+            }
+            double *row = prox_sweep.data() + k * swept;
+            prox_feature.visit_sweep([&](double value) { *row++ = value; });
+        }
+        if (active.tpscore) {
+            timed(tpscore_extractor, k, [&] { f_tpscore.compute(doc, views[k]); });
+        }
+    }
+
+    /* The `doc_entry` of document `k` of the last scored batch, `doc_idx` its forward index. */
+    doc_entry entry(size_t k, int docid, const Document &doc_idx, double stage0_score) {
+        uint64_t  start = profile ? read_cycles() : 0;
+        doc_entry doc(docid, 0);
+        if (statics) {
+            statics->copy(docid, doc, active.stream, active.tags);
+            doc.stage0_score = stage0_score;
+        } else {
+            doc = document_entry(docid, doc_idx, stage0_score);
+        }
+        if (profile) {
+            profile->add(index_extractor, terms(k), doc_idx.length(), read_cycles() - start);
+        }
+        compute(k, doc);
+        return doc;
+    }
+
+    /* Calls `f(value)` for the sweep columns of document `k`, which follow its `doc_entry`. */
+    template <class F>
+    void visit_sweep(size_t k, F &&f) const {
+        for (size_t c = batch_scorer::model_count * batch_scorer::scope_count;
+             c < matrix.columns();
+             ++c) {
+            f(matrix.column(c)[k]);
+        }
+        size_t swept = prox_feature.sweep_names().size();
+        for (size_t c = 0; c < swept; ++c) {
+            f(prox_sweep[k * swept + c]);
+        }
+    }
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Time stamp counter, or a nanosecond clock where there is none. */
+inline uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+/**
+ * Cycles spent by each extractor on the documents it ran on, binned by the number of query terms
+ * and by the power of two below the document length. Each thread keeps its own profile, the
+ * profiles are summed once the run is over.
+ */
+class feature_profile {
+    static constexpr size_t query_bins  = 8;
+    static constexpr size_t length_bins = 32;
+
+    size_t                m_extractors;
+    std::vector<double>   m_cycles;
+    std::vector<uint64_t> m_docs;
+
+    static size_t query_bin(size_t terms) {
+        return terms == 0 ? 0 : terms < query_bins ? terms - 1 : query_bins - 1;
+    }
+
+    static size_t length_bin(double length) {
+        size_t bin = 0;
+        for (double l = 2; l <= length && bin + 1 < length_bins; l *= 2) {
+            ++bin;
+        }
+        return bin;
+    }
+
+    size_t slot(size_t extractor, size_t q, size_t l) const {
+        return (extractor * query_bins + q) * length_bins + l;
+    }
+
+   public:
+    explicit feature_profile(size_t extractors)
+        : m_extractors(extractors),
+          m_cycles(extractors * query_bins * length_bins, 0.0),
+          m_docs(extractors * query_bins * length_bins, 0) {}
+
+    /* Adds the `cycles` of one extractor on a document of `length` for a query of `terms`. */
+    void add(size_t extractor, size_t terms, double length, double cycles) {
+        size_t s = slot(extractor, query_bin(terms), length_bin(length));
+        m_cycles[s] += cycles;
+        ++m_docs[s];
+    }
+
+    feature_profile &operator+=(const feature_profile &other) {
+        for (size_t s = 0; s < m_cycles.size(); ++s) {
+            m_cycles[s] += other.m_cycles[s];
+            m_docs[s] += other.m_docs[s];
+        }
+        return *this;
+    }
+
+    /* Mean cycles per document of an extractor, 0 if it never ran. */
+    double mean(size_t extractor) const {
+        double   cycles = 0;
+        uint64_t docs   = 0;
+        for (size_t s = slot(extractor, 0, 0); s < slot(extractor + 1, 0, 0); ++s) {
+            cycles += m_cycles[s];
+            docs += m_docs[s];
+        }
+        return docs ? cycles / docs : 0.0;
+    }
+
+    /*
+     * One CSV row per extractor and non-empty bin: the query terms (the last bin holds longer
+     * queries), the document length range, the documents and the mean cycles per document.
+     */
+    void write_details(std::ostream &os, const std::vector<std::string> &names) const {
+        os << "extractor,query_terms,min_length,max_length,documents,cycles\n";
+        for (size_t e = 0; e < m_extractors; ++e) {
+            for (size_t q = 0; q < query_bins; ++q) {
+                for (size_t l = 0; l < length_bins; ++l) {
+                    size_t s = slot(e, q, l);
+                    if (m_docs[s] == 0) {
+                        continue;
+                    }
+                    os << names[e] << "," << q + 1 << (q + 1 == query_bins ? "+" : "") << ","
+                       << (l ? uint64_t(1) << l : 0) << "," << (uint64_t(1) << (l + 1)) - 1 << ","
+                       << m_docs[s] << "," << std::llround(m_cycles[s] / m_docs[s]) << "\n";
+                }
+            }
+        }
+    }
+};
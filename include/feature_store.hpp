@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/map.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+
+#include "lexicon.hpp"
+
+#include "features/query_doc_view.hpp"
+
+/*
+ * Values of a feature for every row of a `feature_store`, computed by extractor `version`. A row
+ * is `known` once computed, as an extractor may compute NaN.
+ */
+struct feature_column {
+    std::string          name;
+    uint32_t             version = 0;
+    std::vector<double>  values;
+    std::vector<uint8_t> known;
+
+    void add() {
+        values.push_back(std::numeric_limits<double>::quiet_NaN());
+        known.push_back(0);
+    }
+
+    void reset(size_t r) {
+        values[r] = std::numeric_limits<double>::quiet_NaN();
+        known[r]  = 0;
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(name, version, values, known);
+    }
+};
+
+/**
+ * Feature values of (qid, docno) rows kept from one run of `generate_document_features` to the
+ * next over the same index, so a run only computes the values it is missing. A value not computed
+ * yet reads as NaN: rows added by a later run are missing in every column, as are the rows of a
+ * query whose terms changed, and a column whose extractor version changed is missing in every row
+ * until it is computed again.
+ *
+ * Like a `StaticFeatures` table, a store is only valid for the index, lexicon and field ids it was
+ * built with, which `index` checks.
+ */
+class feature_store {
+    uint64_t                                m_num_docs   = 0;
+    uint64_t                                m_term_count = 0;
+    std::vector<int>                        m_field_ids;
+    std::map<int, std::string>              m_queries;
+    std::vector<int>                        m_qids;
+    std::vector<std::string>                m_docnos;
+    std::vector<feature_column>             m_columns;
+    std::unordered_map<std::string, size_t> m_rows;
+
+    static std::string key(int qid, const std::string &docno) {
+        return std::to_string(qid) + ' ' + docno;
+    }
+
+   public:
+    size_t rows() const { return m_qids.size(); }
+
+    /*
+     * Ties an empty store to the collection of `lexicon` and the field ids of `view`, exits if a
+     * store with rows was built over another one.
+     */
+    void index(const Lexicon &lexicon, const query_doc_view &view) {
+        std::vector<int> field_ids;
+        for (size_t f = 0; f < query_doc_view::field_count; ++f) {
+            field_ids.push_back(view.field_at(f).id);
+        }
+        if (rows() > 0 && (m_num_docs != lexicon.document_count() ||
+                           m_term_count != lexicon.term_count() || m_field_ids != field_ids)) {
+            std::cerr << "Feature store built for another index" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_num_docs   = lexicon.document_count();
+        m_term_count = lexicon.term_count();
+        m_field_ids  = field_ids;
+    }
+
+    /* Records the terms of query `qid`, the values of its rows are missing if they changed. */
+    void query(int qid, const std::vector<std::string> &terms) {
+        std::string text;
+        for (auto &&term : terms) {
+            text += (text.empty() ? "" : " ") + term;
+        }
+        auto it = m_queries.insert(std::make_pair(qid, text));
+        if (it.second || it.first->second == text) {
+            return;
+        }
+        it.first->second = text;
+        for (size_t r = 0; r < rows(); ++r) {
+            if (m_qids[r] != qid) {
+                continue;
+            }
+            for (auto &&c : m_columns) {
+                c.reset(r);
+            }
+        }
+    }
+
+    /* The row of (`qid`, `docno`), added with every value missing if the store has none. */
+    size_t row(int qid, const std::string &docno) {
+        auto it = m_rows.insert(std::make_pair(key(qid, docno), rows()));
+        if (it.second) {
+            m_qids.push_back(qid);
+            m_docnos.push_back(docno);
+            for (auto &&c : m_columns) {
+                c.add();
+            }
+        }
+        return it.first->second;
+    }
+
+    /*
+     * The column `name` at `version`, added with every value missing if the store has none. A
+     * column of another version is discarded.
+     */
+    size_t column(const std::string &name, uint32_t version) {
+        size_t c = 0;
+        while (c < m_columns.size() && m_columns[c].name != name) {
+            ++c;
+        }
+        if (c == m_columns.size()) {
+            m_columns.emplace_back();
+            m_columns[c].name = name;
+        } else if (m_columns[c].version == version) {
+            return c;
+        }
+        m_columns[c].version = version;
+        m_columns[c].values.clear();
+        m_columns[c].known.clear();
+        for (size_t r = 0; r < rows(); ++r) {
+            m_columns[c].add();
+        }
+        return c;
+    }
+
+    /* True if column `c` has a value for each of `rows`. */
+    bool complete(size_t c, const std::vector<size_t> &rows) const {
+        for (size_t r : rows) {
+            if (!m_columns[c].known[r]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* True if row `r` lacks a value in any of `columns`. */
+    bool missing(size_t r, const std::vector<size_t> &columns) const {
+        for (size_t c : columns) {
+            if (!m_columns[c].known[r]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    double value(size_t c, size_t r) const { return m_columns[c].values[r]; }
+
+    void set(size_t c, size_t r, double value) {
+        m_columns[c].values[r] = value;
+        m_columns[c].known[r]  = 1;
+    }
+
+    /* Reads the store of `file`, an empty store if there is no such file. */
+    void read(const std::string &file) {
+        std::ifstream ifs(file, std::ios::binary);
+        if (!ifs.is_open()) {
+            return;
+        }
+        cereal::BinaryInputArchive archive(ifs);
+        archive(*this);
+        m_rows.clear();
+        for (size_t r = 0; r < rows(); ++r) {
+            m_rows.insert(std::make_pair(key(m_qids[r], m_docnos[r]), r));
+        }
+    }
+
+    void write(const std::string &file) {
+        std::ofstream ofs(file, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            std::cerr << "Could not open file: " << file << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        cereal::BinaryOutputArchive archive(ofs);
+        archive(*this);
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(m_num_docs, m_term_count, m_field_ids, m_queries, m_qids, m_docnos, m_columns);
+    }
+};
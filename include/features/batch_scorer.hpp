@@ -0,0 +1,540 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "doc_entry.hpp"
+#include "lexicon.hpp"
+
+#include "query_doc_batch.hpp"
+
+/* Feature columns of a batch, column-major: column c holds one value per document. */
+class feature_matrix {
+    size_t              m_columns = 0;
+    size_t              m_rows    = 0;
+    std::vector<double> m_data;
+
+   public:
+    void reset(size_t columns, size_t rows) {
+        m_columns = columns;
+        m_rows    = rows;
+        m_data.assign(columns * rows, 0.0);
+    }
+
+    void reserve(size_t columns, size_t rows) { m_data.reserve(columns * rows); }
+
+    size_t columns() const { return m_columns; }
+    size_t rows() const { return m_rows; }
+
+    double *      column(size_t c) { return m_data.data() + c * m_rows; }
+    const double *column(size_t c) const { return m_data.data() + c * m_rows; }
+};
+
+/**
+ * Evaluates the additive retrieval models over a `query_doc_batch`, one query term at a time
+ * across all documents. Term weights are computed once per term and scope, and length
+ * normalisations once per document and scope; the BM25 and probability loops are plain
+ * arithmetic over contiguous columns, which the compiler vectorises.
+ *
+ * BM25 and LM Dirichlet are families: a list of (k1, b) or mu settings is scored in one pass that
+ * looks up the lexicon and computes idf once per term and scope for all of them. The first three
+ * settings of each are the `doc_entry` features, further settings are sweep columns.
+ *
+ * Every score adds up terms in `q_ft` order, with the expressions of the rank helpers that the
+ * term features also use (`rank_bm25`, `calculate_lm`, ...), split into per-term weights and
+ * per-document normalisations.
+ */
+class batch_scorer {
+   public:
+#define BATCH_SCORER_COLUMN(type, name)
+#define BATCH_SCORER_MODEL(X, name) name,
+    /* The `doc_entry` models in the order of their columns. */
+    enum model : size_t { DOC_ENTRY_FEATURES(BATCH_SCORER_COLUMN, BATCH_SCORER_MODEL) };
+#undef BATCH_SCORER_MODEL
+
+#define BATCH_SCORER_COUNT(X, name) +1
+    /* Models stored in `doc_entry`, sweep settings follow as further models. */
+    static constexpr size_t model_count =
+        0 DOC_ENTRY_FEATURES(BATCH_SCORER_COLUMN, BATCH_SCORER_COUNT);
+#undef BATCH_SCORER_COUNT
+
+    /* Scope 0 is the whole document, scope 1 + f the scored field slot f. */
+    static constexpr size_t scope_count = 1 + query_doc_batch::fields;
+#define BATCH_SCORER_SCOPE(type, name) +1
+    static_assert(scope_count == 0 DOC_ENTRY_SCOPES(BATCH_SCORER_SCOPE, model),
+                  "DOC_ENTRY_SCOPES lists a column per scope");
+#undef BATCH_SCORER_SCOPE
+
+    static size_t column(size_t m, size_t scope) { return m * scope_count + scope; }
+
+    /* The `doc_entry` BM25 models, whose normalisations only depend on the document. */
+    static constexpr size_t norm_models = bm25_trec3_kmax + 1;
+
+    /* Name of column `column(m, scope)` in `doc_entry` for m < model_count. */
+    static std::string column_name(size_t m, size_t scope) {
+#define BATCH_SCORER_NAME(X, name) #name,
+        static const std::array<std::string, model_count> names = {
+            {DOC_ENTRY_FEATURES(BATCH_SCORER_COLUMN, BATCH_SCORER_NAME)}};
+#undef BATCH_SCORER_NAME
+        return scope == 0 ? names[m] : names[m] + "_" + query_doc_view::names()[scope - 1];
+    }
+
+    struct bm25_params {
+        double k1;
+        double b;
+    };
+
+    /* Every (k1, b) with k1 from `k1s` and b from `bs`. */
+    static std::vector<bm25_params> grid(const std::vector<double> &k1s,
+                                         const std::vector<double> &bs) {
+        std::vector<bm25_params> settings;
+        for (auto &&k1 : k1s) {
+            for (auto &&b : bs) {
+                settings.push_back(bm25_params{k1, b});
+            }
+        }
+        return settings;
+    }
+
+    /* Column of the BM25 sweep setting `p`, its field columns add the field name. */
+    static std::string sweep_name(const bm25_params &p) {
+        std::ostringstream name;
+        name << "bm25_k1_" << p.k1 << "_b_" << p.b;
+        return name.str();
+    }
+
+    /* Column of the LM Dirichlet sweep setting `mu`. */
+    static std::string sweep_name(double mu) {
+        std::ostringstream name;
+        name << "lm_dir_" << mu;
+        return name.str();
+    }
+
+   private:
+    /*
+     * A model computes its per-term weights in `term` and `field`, which return false for a term
+     * the model skips, a per-document length normalisation in `norm`, and one summand in `score`.
+     * Weights only depend on the collection, so one setting computes them for its whole family.
+     */
+    struct bm25_model {
+        double k1, b, num_docs, avg_doc_len;
+        struct weight {
+            double w_qt;
+        };
+
+        bool term(const Lexicon &lex, uint64_t tid, int qf, weight &w) const {
+            return !lex.is_oov(tid) && idf(qf, lex[tid].document_count(), w);
+        }
+        bool field(const Lexicon &lex, uint64_t tid, int qf, int id, weight &w) const {
+            return idf(qf, lex[tid].field_document_count(id), w);
+        }
+        bool idf(double f_qt, double f_t, weight &w) const {
+            w.w_qt = std::max(1e-6, std::log((num_docs - f_t + 0.5) / (f_t + 0.5)) * f_qt);
+            return true;
+        }
+        double norm(double len) const { return k1 * ((1 - b) + (b * (len / avg_doc_len))); }
+        double score(const weight &w, double tf, double, double norm) const {
+            return ((k1 + 1) * tf) / (norm + tf) * w.w_qt;
+        }
+    };
+
+    struct lm_model {
+        double mu, coll_len;
+        struct weight {
+            double c_f;
+        };
+
+        bool term(const Lexicon &lex, uint64_t tid, int, weight &w) const {
+            if (lex.is_oov(tid)) {
+                return false;
+            }
+            w.c_f = lex[tid].term_count();
+            return true;
+        }
+        bool field(const Lexicon &lex, uint64_t tid, int, int id, weight &w) const {
+            w.c_f = lex[tid].field_term_count(id);
+            return true;
+        }
+        double norm(double len) const { return len + mu; }
+        double score(const weight &w, double tf, double, double norm) const {
+            return std::log((tf + mu * w.c_f / coll_len) / norm);
+        }
+    };
+
+    struct tfidf_model {
+        double num_docs;
+        struct weight {
+            double w_Qq;
+        };
+
+        bool term(const Lexicon &lex, uint64_t tid, int, weight &w) const {
+            if (lex.is_oov(tid)) {
+                return false;
+            }
+            w.w_Qq = std::log(1.0 + (num_docs / lex[tid].term_count()));
+            return true;
+        }
+        bool field(const Lexicon &lex, uint64_t tid, int, int id, weight &w) const {
+            int field_term_cnt = lex[tid].field_term_count(id);
+            w.w_Qq             = std::log(1.0 + (num_docs / field_term_cnt));
+            return field_term_cnt != 0;
+        }
+        double norm(double len) const { return 1.0 / len; }
+        double score(const weight &w, double tf, double, double norm) const {
+            return norm * (1.0 + std::log(tf)) * w.w_Qq;
+        }
+    };
+
+    struct prob_model {
+        struct weight {};
+
+        // only term id 0 is skipped, not the out-of-vocabulary terms
+        bool   term(const Lexicon &, uint64_t tid, int, weight &) const { return tid != 0; }
+        bool   field(const Lexicon &, uint64_t, int, int, weight &) const { return true; }
+        double norm(double) const { return 0.0; }
+        double score(const weight &, double tf, double len, double) const { return tf / len; }
+    };
+
+    struct be_model {
+        double num_docs, avg_doc_len;
+        struct weight {
+            double l, r;
+        };
+
+        bool term(const Lexicon &lex, uint64_t tid, int, weight &w) const {
+            return !lex.is_oov(tid) && cf(lex[tid].term_count(), w);
+        }
+        bool field(const Lexicon &lex, uint64_t tid, int, int id, weight &w) const {
+            int field_term_cnt = lex[tid].field_term_count(id);
+            return field_term_cnt != 0 && cf(field_term_cnt, w);
+        }
+        bool cf(uint64_t c_f, weight &w) const {
+            w.l = std::log(1.0 + (double)c_f / num_docs);
+            w.r = std::log(1.0 + num_docs / (double)c_f);
+            return true;
+        }
+        double norm(double len) const { return std::log(1.0 + avg_doc_len / len); }
+        double score(const weight &w, double tf, double, double norm) const {
+            double prime = tf * norm;
+            return (w.l + prime * w.r) / (prime + 1.0);
+        }
+    };
+
+    struct dph_model {
+        double num_docs, avg_doc_len;
+        struct weight {
+            double n_cf;
+        };
+
+        bool term(const Lexicon &lex, uint64_t tid, int, weight &w) const {
+            if (lex.is_oov(tid)) {
+                return false;
+            }
+            w.n_cf = num_docs / (double)lex[tid].term_count();
+            return true;
+        }
+        bool field(const Lexicon &lex, uint64_t tid, int, int id, weight &w) const {
+            int field_term_cnt = lex[tid].field_term_count(id);
+            w.n_cf             = num_docs / (double)(uint64_t)field_term_cnt;
+            return field_term_cnt != 0;
+        }
+        double norm(double) const { return 0.0; }
+        double score(const weight &w, double tf, double len, double) const {
+            double f    = tf / len;
+            double norm = (1.0 - f) * (1.0 - f) / (tf + 1.0);
+            return 1.0 * norm *
+                   (tf * std::log2((tf * avg_doc_len / len) * w.n_cf) +
+                    0.5 * std::log2(2.0 * M_PI * tf * (1.0 - f)));
+        }
+    };
+
+    struct dfr_model {
+        double num_docs, avg_doc_len;
+        struct weight {
+            double fp1, ir, c_idf;
+        };
+
+        bool term(const Lexicon &lex, uint64_t tid, int, weight &w) const {
+            return !lex.is_oov(tid) &&
+                   cf(lex[tid].term_count(), (uint32_t)lex[tid].document_count(), w);
+        }
+        bool field(const Lexicon &lex, uint64_t tid, int, int id, weight &w) const {
+            int field_term_cnt = lex[tid].field_term_count(id);
+            if (0 == field_term_cnt) {
+                return false;
+            }
+            int field_doc_cnt = lex[tid].field_document_count(id);
+            return field_doc_cnt != 0 && cf(field_term_cnt, field_doc_cnt, w);
+        }
+        bool cf(uint64_t c_f, uint32_t c_idf, weight &w) const {
+            double ne = num_docs * (1.0 - std::pow((num_docs - 1.0) / num_docs, c_f));
+            w.fp1     = c_f + 1.0;
+            w.ir      = std::log2((num_docs + 1.0) / (ne + 0.5));
+            w.c_idf   = c_idf;
+            return true;
+        }
+        double norm(double len) const { return std::log2(1.0 + avg_doc_len / len); }
+        double score(const weight &w, double tf, double, double norm) const {
+            double prime = tf * norm;
+            return prime * w.ir * (w.fp1 / (w.c_idf * (prime + 1.0)));
+        }
+    };
+
+    const Lexicon &          m_lexicon;
+    uint64_t                 m_coll_len;
+    uint64_t                 m_num_docs;
+    double                   m_avg_doc_len;
+    std::vector<bm25_model>  m_bm25;
+    std::vector<size_t>      m_bm25_models;
+    std::vector<lm_model>    m_lm;
+    std::vector<size_t>      m_lm_models;
+    std::vector<std::string> m_sweep_names;
+    size_t                   m_model_count = model_count;
+    std::vector<bool>        m_enabled     = std::vector<bool>(model_count, true);
+    std::vector<double>      m_norm;
+
+    void add_sweep_names(const std::string &prefix) {
+        m_sweep_names.push_back(prefix);
+        for (size_t f = 0; f < query_doc_batch::fields; ++f) {
+            m_sweep_names.push_back(prefix + "_" + query_doc_view::names()[f]);
+        }
+    }
+
+    /*
+     * Adds the scores of `count` settings of one model, setting i to the `scope_count` columns of
+     * model `models[i]`. Terms are skipped and weighted once for all settings.
+     */
+    template <class Model>
+    void run(const query_doc_batch &batch,
+             feature_matrix &       out,
+             const Model *          settings,
+             const size_t *         models,
+             size_t                 count) {
+        if (count == 0) {
+            return;
+        }
+        size_t n = batch.size();
+        m_norm.resize(count * scope_count * n);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t s = 0; s < scope_count; ++s) {
+                const double *len   = s == 0 ? batch.len() : batch.field_len(s - 1);
+                const double *fixed = batch.norm(column(models[i], s));
+                double *      norm  = &m_norm[(i * scope_count + s) * n];
+                if (fixed) {
+                    std::copy(fixed, fixed + n, norm);
+                    continue;
+                }
+                for (size_t d = 0; d < n; ++d) {
+                    norm[d] = settings[i].norm(len[d]);
+                }
+            }
+        }
+
+        const Model &          family = settings[0];
+        typename Model::weight w;
+        for (size_t t = 0; t < batch.terms(); ++t) {
+            auto tid = batch.tid(t);
+            // skip non-existent terms
+            if (!family.term(m_lexicon, tid, batch.qf(t), w)) {
+                continue;
+            }
+            const double *tf  = batch.tf(t);
+            const double *len = batch.len();
+            for (size_t i = 0; i < count; ++i) {
+                const Model & mod  = settings[i];
+                const double *norm = &m_norm[i * scope_count * n];
+                double *      acc  = out.column(column(models[i], 0));
+                for (size_t d = 0; d < n; ++d) {
+                    acc[d] += tf[d] != 0 ? mod.score(w, tf[d], len[d], norm[d]) : 0.0;
+                }
+            }
+
+            for (size_t f = 0; f < query_doc_batch::fields; ++f) {
+                int id = batch.field_id(f);
+                // field is not indexed
+                if (id < 1 || !family.field(m_lexicon, tid, batch.qf(t), id, w)) {
+                    continue;
+                }
+                const double *ftf  = batch.field_tf(t, f);
+                const double *flen = batch.field_len(f);
+                for (size_t i = 0; i < count; ++i) {
+                    const Model & mod   = settings[i];
+                    const double *fnorm = &m_norm[(i * scope_count + f + 1) * n];
+                    double *      facc  = out.column(column(models[i], f + 1));
+                    for (size_t d = 0; d < n; ++d) {
+                        bool hit = tf[d] != 0 && flen[d] != 0 && ftf[d] != 0;
+                        facc[d] += hit ? mod.score(w, ftf[d], flen[d], fnorm[d]) : 0.0;
+                    }
+                }
+            }
+        }
+    }
+
+    /* Scores every setting of a family as one `timed` call. */
+    template <class Timer, class Model>
+    void run(Timer &                    timed,
+             const query_doc_batch &    batch,
+             feature_matrix &           out,
+             const std::vector<Model> & settings,
+             const std::vector<size_t> &models) {
+        if (!settings.empty()) {
+            timed(models.data(), models.size(), [&] {
+                run(batch, out, settings.data(), models.data(), settings.size());
+            });
+        }
+    }
+
+    template <class Timer, class Model>
+    void run(Timer &timed, const query_doc_batch &batch, feature_matrix &out, size_t m,
+             const Model &mod) {
+        if (m_enabled[m]) {
+            timed(&m, size_t(1), [&] { run(batch, out, &mod, &m, 1); });
+        }
+    }
+
+    struct untimed {
+        template <class F>
+        void operator()(const size_t *, size_t, F &&run) const {
+            run();
+        }
+    };
+
+    /* Drops the settings of disabled `doc_entry` models from a family. */
+    template <class Model>
+    void select_settings(std::vector<Model> &settings, std::vector<size_t> &models) {
+        size_t kept = 0;
+        for (size_t i = 0; i < settings.size(); ++i) {
+            if (models[i] >= model_count || m_enabled[models[i]]) {
+                settings[kept] = settings[i];
+                models[kept]   = models[i];
+                ++kept;
+            }
+        }
+        settings.resize(kept);
+        models.resize(kept);
+    }
+
+   public:
+    /*
+     * Scores the `doc_entry` models plus every setting of `bm25_sweep` and `lm_sweep`, which are
+     * appended in order as sweep columns.
+     */
+    explicit batch_scorer(const Lexicon &                 lexicon,
+                          const std::vector<bm25_params> &bm25_sweep = {},
+                          const std::vector<double> &     lm_sweep   = {})
+        : m_lexicon(lexicon),
+          m_coll_len(lexicon.term_count()),
+          m_num_docs(lexicon.document_count()),
+          m_avg_doc_len((double)m_coll_len / m_num_docs) {
+        // parameters of the bm25_atire, bm25_trec3, bm25_trec3_kmax and lm_dir_* columns
+        std::vector<bm25_params> bm25 = {{90 / 100.0, 40 / 100.0},
+                                         {120 / 100.0, 75 / 100.0},
+                                         {200 / 100.0, 75 / 100.0}};
+        std::vector<double>      lm   = {2500, 1500, 1000};
+        m_bm25_models = {bm25_atire, bm25_trec3, bm25_trec3_kmax};
+        m_lm_models   = {lm_dir_2500, lm_dir_1500, lm_dir_1000};
+
+        for (auto &&p : bm25_sweep) {
+            add_sweep_names(sweep_name(p));
+            bm25.push_back(p);
+            m_bm25_models.push_back(m_model_count++);
+        }
+        for (auto &&mu : lm_sweep) {
+            add_sweep_names(sweep_name(mu));
+            lm.push_back(mu);
+            m_lm_models.push_back(m_model_count++);
+        }
+
+        for (auto &&p : bm25) {
+            m_bm25.push_back(bm25_model{p.k1, p.b, (double)m_num_docs, m_avg_doc_len});
+        }
+        for (auto &&mu : lm) {
+            m_lm.push_back(lm_model{mu, (double)m_coll_len});
+        }
+    }
+
+    /*
+     * Scores only the `doc_entry` models m with `models[m]` set, the columns of the others stay
+     * zero. Sweep settings are always scored.
+     */
+    void select(const std::vector<bool> &models) {
+        m_enabled = models;
+        select_settings(m_bm25, m_bm25_models);
+        select_settings(m_lm, m_lm_models);
+    }
+
+    /*
+     * Length normalisation K_d of the BM25 model m < `norm_models` for a document or field of
+     * `len` terms, as a batch may bring it precomputed. The model must not be deselected.
+     */
+    double norm(size_t m, double len) const {
+        auto it = std::find(m_bm25_models.begin(), m_bm25_models.end(), m);
+        return m_bm25[it - m_bm25_models.begin()].norm(len);
+    }
+
+    /* Whether any column is scored. */
+    bool active() const {
+        return !m_bm25.empty() || !m_lm.empty() ||
+               std::find(m_enabled.begin(), m_enabled.end(), true) != m_enabled.end();
+    }
+
+    /* Columns after `model_count * scope_count`, one per sweep setting and scope. */
+    const std::vector<std::string> &sweep_names() const { return m_sweep_names; }
+
+    /* Room in `out` and in the normalisations for batches of up to `docs` documents. */
+    void reserve(feature_matrix &out, size_t docs) {
+        out.reserve(m_model_count * scope_count, docs);
+        size_t settings = std::max<size_t>(std::max(m_bm25.size(), m_lm.size()), 1);
+        m_norm.reserve(settings * scope_count * docs);
+    }
+
+    void score(const query_doc_batch &batch, feature_matrix &out) {
+        untimed timed;
+        score(batch, out, timed);
+    }
+
+    /*
+     * Scores the batch, each family as one call `timed(models, count, run)`, where `run()` scores
+     * the `count` models `models`, sweep settings included.
+     */
+    template <class Timer>
+    void score(const query_doc_batch &batch, feature_matrix &out, Timer &timed) {
+        out.reset(m_model_count * scope_count, batch.size());
+
+        run(timed, batch, out, m_bm25, m_bm25_models);
+        run(timed, batch, out, m_lm, m_lm_models);
+
+        double num_docs = m_num_docs;
+        run(timed, batch, out, tfidf, tfidf_model{num_docs});
+        run(timed, batch, out, prob, prob_model{});
+
+        // the DFR models take the document count as 32 bits
+        double num_docs_32 = (uint32_t)m_num_docs;
+        run(timed, batch, out, be, be_model{num_docs_32, m_avg_doc_len});
+        run(timed, batch, out, dph, dph_model{num_docs_32, m_avg_doc_len});
+        run(timed, batch, out, dfr, dfr_model{num_docs_32, m_avg_doc_len});
+    }
+
+    /* Copies document `row` of a scored batch into its `doc_entry` fields. */
+    static void store(const feature_matrix &matrix, size_t row, doc_entry &doc) {
+        using fields = std::array<double doc_entry::*, scope_count>;
+#define BATCH_SCORER_MEMBER(type, name) &doc_entry::name,
+#define BATCH_SCORER_MEMBERS(X, name) {{DOC_ENTRY_SCOPES(BATCH_SCORER_MEMBER, name)}},
+        static const std::array<fields, model_count> members = {
+            {DOC_ENTRY_FEATURES(BATCH_SCORER_COLUMN, BATCH_SCORER_MEMBERS)}};
+#undef BATCH_SCORER_MEMBERS
+#undef BATCH_SCORER_MEMBER
+        for (size_t m = 0; m < model_count; ++m) {
+            for (size_t s = 0; s < scope_count; ++s) {
+                doc.*members[m][s] = matrix.column(column(m, s))[row];
+            }
+        }
+    }
+};
+
+#undef BATCH_SCORER_COLUMN
@@ -15,11 +15,17 @@ struct rank_bm25 {
                               const double f_dt,
                               const double f_t,
                               const double W_d) const {
-        double w_qt =
-            std::max(epsilon_score, std::log((num_docs - f_t + 0.5) / (f_t + 0.5)) * f_qt);
-        double K_d  = k1 * ((1 - b) + (b * (W_d / avg_doc_len)));
-        double w_dt = ((k1 + 1) * f_dt) / (K_d + f_dt);
+        return calculate_tf_score(f_dt, W_d) * calculate_idf(f_qt, f_t);
+    }
+
+    /* The document part of a score, `calculate_docscore` is this times `calculate_idf`. */
+    double calculate_tf_score(const double f_dt, const double W_d) const {
+        double K_d = k1 * ((1 - b) + (b * (W_d / avg_doc_len)));
+        return ((k1 + 1) * f_dt) / (K_d + f_dt);
+    }
 
-        return w_dt * w_qt;
+    /* The term part of a score, the same for every document. */
+    double calculate_idf(const double f_qt, const double f_t) const {
+        return std::max(epsilon_score, std::log((num_docs - f_t + 0.5) / (f_t + 0.5)) * f_qt);
     }
 };
\ No newline at end of file
@@ -1,24 +1,8 @@
 #pragma once
 
-#include "doc_feature.hpp"
-
-#include "bm25/doc_bm25_atire_feature.hpp"
-#include "bm25/doc_bm25_trec3_feature.hpp"
-#include "bm25/doc_bm25_trec3_kmax_feature.hpp"
-
-#include "lmds/doc_lm_dir_1000_feature.hpp"
-#include "lmds/doc_lm_dir_1500_feature.hpp"
-#include "lmds/doc_lm_dir_2500_feature.hpp"
-
-#include "tfidf/doc_tfidf_feature.hpp"
-
-#include "bose_einstein/doc_be_feature.hpp"
-
-#include "dfr/doc_dfr_feature.hpp"
-
-#include "dph/doc_dph_feature.hpp"
-
-#include "probability/doc_prob_feature.hpp"
+#include "query_doc_view.hpp"
+#include "query_doc_batch.hpp"
+#include "batch_scorer.hpp"
 
 #include "stream/doc_stream_feature.hpp"
 
@@ -15,11 +15,18 @@ struct bm25_proximity {
     double                avg_doc_len;
 
     double score(const double f_qt, const double f_dt, const double f_t, const double W_d) const {
-        double w_qt = std::max(epsilon_score, std::log((num_docs / f_t) * f_qt));
-        double K_d  = k1 * ((1 - b) + (b * (W_d / avg_doc_len)));
-        double w_dt = ((k1 + 1) * f_dt) / (K_d + f_dt);
+        return calculate_tf_score(f_dt, W_d) * calculate_idf(f_qt, f_t);
+    }
 
-        return w_dt * w_qt;
+    /**
+     * the query term weight of `score`, which only depends on the term
+     *
+     * @param double f_qt. query term frequency
+     * @param double f_t. df value
+     * @return double. w_qt
+     */
+    double calculate_idf(const double f_qt, const double f_t) const {
+        return std::max(epsilon_score, std::log((num_docs / f_t) * f_qt));
     }
 
     /**
@@ -1,9 +1,6 @@
 #pragma once
 
 #include <algorithm>
-#include <iostream>
-#include <map>
-#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,235 +21,305 @@ struct term_data {
     double w_q;
     // Query pos
     int query_pos;
+    // BM25 weight of the query term
+    double w_qt;
+    // Positions of the term in the document
+    PosSpan positions;
+
+    term_data() = default;
+
+    term_data(uint64_t id,
+              uint64_t term_count,
+              size_t   freq_dt,
+              double   idf_weight,
+              int      qpos,
+              double   qt_weight,
+              PosSpan  pos)
+        : tid(id),
+          total_term_docs(term_count),
+          f_dt(freq_dt),
+          w_q(idf_weight),
+          query_pos(qpos),
+          w_qt(qt_weight),
+          positions(pos) {}
+};
 
-    term_data() : term_data(0, 0, 0, 0, 0) {}
+/* A bigram window of the proximity family, an ordered one counting pairs in query order only. */
+struct proximity_window {
+    int  window  = 8;
+    bool ordered = false;
 
-    term_data(int id, uint64_t term_count, size_t freq_dt, double idf_weight, int qpos)
-        : tid(id), total_term_docs(term_count), f_dt(freq_dt), w_q(idf_weight), query_pos(qpos) {}
+    std::string name() const {
+        return std::string("bm25_bigram_") + (ordered ? "o" : "u") + std::to_string(window);
+    }
 };
 
+/**
+ * Term proximity features of a document. The query terms found in the document are kept in flat
+ * tables indexed by query slot, a repeated query term taking one slot per occurrence, and their
+ * position lists are read in place and merged rather than copied and sorted. The tables are
+ * reused from one document to the next.
+ *
+ * The features form a family over bigram windows and TP-dist window sizes: the first setting of
+ * each is the `doc_entry` feature (u8 and w100), the others are sweep columns. Every setting is
+ * accumulated in the same pass over the positions, so a sweep costs little more than one window.
+ */
 class doc_proximity_feature {
 
-    const int        cdf_empty = -1;
     Lexicon &        lexicon;
     bm25_proximity<> ranker;
-    size_t           feature_id = 0;
-    double           score      = 0.0;
 
-    // term stats cache
-    std::map<uint64_t, term_data> term_data_map;
+    std::vector<proximity_window> m_windows;
+    std::vector<int>              m_tp_windows;
+    std::vector<std::string>      m_sweep_names;
+    int                           m_max_window = 0;
+
+    // BM25 weight of each query term in the lexicon, for the query of `prepare`
+    std::vector<double> m_qt_weights;
+
+    // values of the settings for the last document
+    std::vector<double> m_bigram_values;
+    std::vector<double> m_tp_values;
+
+    // slots of the query terms in the document
+    std::vector<term_data>                     m_terms;
+    // bigram score of each slot, computed on first use
+    std::vector<double>                        m_bigram_scores;
+    // slots by increasing f_dt, a later slot before an earlier one of the same f_dt
+    std::vector<size_t>                        m_by_freq;
+    // merge cursor of each slot
+    std::vector<const uint32_t *>              m_cursors;
+    // TP-dist scores of a term pair by window and the walk state behind them
+    std::vector<std::pair<double, double>>     m_tp_scores;
+    std::vector<std::pair<uint64_t, uint64_t>> m_tp_prev;
+
+    double bigram_score(size_t slot, int doc_length) {
+        if (m_bigram_scores[slot] < 0) {
+            auto &t               = m_terms[slot];
+            m_bigram_scores[slot] = ranker.calculate_tf_score(t.f_dt, doc_length) * t.w_qt;
+        }
+        return m_bigram_scores[slot];
+    }
 
    public:
-    doc_proximity_feature(Lexicon &lex) : lexicon(lex) {
+    /*
+     * The sweep settings `windows` and `tp_windows` follow the `doc_entry` ones, a setting given
+     * twice or equal to a `doc_entry` one is kept once.
+     */
+    doc_proximity_feature(Lexicon &                            lex,
+                          const std::vector<proximity_window> &windows    = {},
+                          const std::vector<int> &             tp_windows = {})
+        : lexicon(lex), m_windows(1, proximity_window()), m_tp_windows(1, 100) {
         ranker.num_docs    = lex.document_count();
         auto num_terms     = lex.term_count();
         ranker.avg_doc_len = (double)num_terms / ranker.num_docs;
+
+        for (auto &&w : windows) {
+            auto same = [&](const proximity_window &o) { return o.name() == w.name(); };
+            if (std::any_of(m_windows.begin(), m_windows.end(), same)) {
+                continue;
+            }
+            m_windows.push_back(w);
+            m_sweep_names.push_back(w.name());
+        }
+        for (int w : tp_windows) {
+            if (std::find(m_tp_windows.begin(), m_tp_windows.end(), w) != m_tp_windows.end()) {
+                continue;
+            }
+            m_tp_windows.push_back(w);
+            m_sweep_names.push_back(tp_dist_name(w));
+        }
+        for (auto &&w : m_windows) {
+            m_max_window = std::max(m_max_window, w.window - 1);
+        }
+        m_bigram_values.assign(m_windows.size(), 0.0);
+        m_tp_values.assign(m_tp_windows.size(), 0.0);
+    }
+
+    /* Room for queries of up to `terms` terms. */
+    void reserve(size_t terms) {
+        m_qt_weights.reserve(terms);
+        m_terms.reserve(terms);
+        m_bigram_scores.reserve(terms);
+        m_by_freq.reserve(terms);
+        m_cursors.reserve(terms);
+        m_tp_scores.reserve(m_tp_windows.size());
+        m_tp_prev.reserve(m_tp_windows.size());
+    }
+
+    /* Column of the TP-dist sweep setting `window`. */
+    static std::string tp_dist_name(int window) {
+        return "bm25_tp_dist_w" + std::to_string(window);
     }
 
-    void compute(doc_entry &doc, query_train &query, Document &doc_idx) {
-        score = 0.0;
+    /* Names of the sweep columns, bigram windows first. */
+    const std::vector<std::string> &sweep_names() const { return m_sweep_names; }
+
+    void compute(doc_entry &doc, const query_doc_view &view) {
+        evaluate(view);
+        store(doc);
+    }
+
+    /* Computes the weights of the terms of `query`, before any of its documents. */
+    void prepare(const query_train &query) {
+        m_qt_weights.clear();
+        for (auto &tid : query.tids) {
+            if (lexicon.is_oov(tid)) {
+                continue;
+            }
+            auto f_t = lexicon[tid].document_count();
+            m_qt_weights.push_back(ranker.calculate_idf(query.q_ft.at(tid), f_t));
+        }
+    }
 
-        // condensed direct file
-        std::vector<std::pair<uint64_t, int>> cdf;
-        // for tp_interval_score
-        std::vector<indri::utility::greedy_vector<int>> acc_positions;
-        std::vector<term_data>                          acc_terms;
+    /* Computes every setting of the family for the document of `view`, once `prepare`d. */
+    void evaluate(const query_doc_view &view) {
+        auto &query = view.query();
+        m_terms.clear();
+        m_by_freq.clear();
+        std::fill(m_bigram_values.begin(), m_bigram_values.end(), 0.0);
+        std::fill(m_tp_values.begin(), m_tp_values.end(), 0.0);
 
         int i = 0;
-        int s = 0;
         for (auto &tid : query.tids) {
             if (lexicon.is_oov(tid)) {
                 continue;
             }
-            if (doc_idx.freq(tid) !=0) {
-                ++s;
+            auto t = view.find(tid);
+            if (t != nullptr && t->tf != 0) {
                 term_data curr_term(tid,
                                     lexicon[tid].document_count(),
-                                    doc_idx.freq(tid),
-                                    ranker.calculate_wq(doc_idx.freq(tid)),
-                                    query.pos[i]);
-                term_data_map.insert(std::pair<uint64_t, term_data>(tid, curr_term));
-
-                _acc_positions_insert(acc_positions, doc_idx.positions(tid), acc_terms, curr_term);
-
-                for (auto pos : doc_idx.positions(tid)) {
-                    cdf.push_back(std::make_pair(tid, pos));
-                }
+                                    t->tf,
+                                    ranker.calculate_wq(t->tf),
+                                    query.pos[i],
+                                    m_qt_weights[i],
+                                    *t->positions);
+                _acc_positions_insert(curr_term);
             }
             ++i;
         }
 
-        if (s < 2) {
+        if (m_terms.size() < 2) {
             return;
         }
 
-        // sort cdf
-        std::sort(cdf.begin(),
-                  cdf.end(),
-                  [](const std::pair<uint64_t, int> &lhs, const std::pair<uint64_t, int> &rhs) {
-                      return lhs.second < rhs.second;
-                  });
-
         // find bigrams of all query term pairs
-        score = 0.0;
-        cdf_search(TP_BIGRAM, cdf, query, 8, doc.length);
-        doc.bm25_bigram_u8 = score;
+        bigram_window_scores(view.length());
 
         // Xiaolu, et al.
-        doc.bm25_tp_dist_w100 = tp_interval_score(acc_positions, acc_terms, 100, doc.length);
-
-        // Clear for next doc
-        term_data_map.clear();
+        tp_interval_scores(view.length());
     }
 
-    enum term_pair_type {
-        TP_NONE = 0,
-        TP_BIGRAM,
-        TP_ORDERED,
-        TP_UNORDERED,
-    };
-
-    struct term_pair {
-        enum term_pair_type type;
-        int                 distance;
-        std::pair<int, int> term_a;
-        std::pair<int, int> term_b;
-        double              score;
-
-        term_pair(enum term_pair_type ty,
-                  int                 dist,
-                  std::pair<int, int> a,
-                  std::pair<int, int> b,
-                  double              s)
-            : type(ty), distance(dist), term_a(a), term_b(b), score(s) {}
-    };
-
-    // Takes a sorted condensed direct file (CDF) of query terms that appear in
-    // the document. It is assumed the CDF is sorted according to term position,
-    // the query term pairs may appear unordered as they occur within the
-    // document. The main loop in this function performs a bigram scan over these
-    // unordered query term pairs in the order that they appear within the CDF.
-    void cdf_search(const enum term_pair_type                    ty,
-                    std::vector<std::pair<uint64_t, int>> const &cdf,
-                    const query_train &                          query,
-                    const int                                    window,
-                    const int                                    doc_length) {
-        std::vector<term_pair> found;
-
-        // Callers of this function will use window parameter of 2 for bigram, 8
-        // for window of 8, etc. But internal to this function the window value is
-        // `window - 1`.
-        const int _window = window - 1;
-
-        for (size_t i = 0; i < cdf.size() - 1; ++i) {
-            // bigram scan
-            for (size_t j = i + 1; j < cdf.size(); i = j++) {
-                auto      lhs  = cdf[i];
-                auto      rhs  = cdf[j];
-                const int dist = rhs.second - lhs.second;
-
-                // Skip bigrams with the same term
-                if (lhs.first == rhs.first) {
-                    continue;
-                }
-
-                // There is no need to check that `lhs.second < rhs.second` (i.e. is
-                // not a bigram) since it is assumed that `cdf` is already sorted
-                // and we're scanning for unordered bigrams for all query terms.
+    /* Stores the `doc_entry` settings of the last document. */
+    void store(doc_entry &doc) const {
+        doc.bm25_bigram_u8    = m_bigram_values[0];
+        doc.bm25_tp_dist_w100 = m_tp_values[0];
+    }
 
-                if (dist > 0 && dist <= _window) {
-                    auto data_a = term_data_map[lhs.first];
-                    auto data_b = term_data_map[rhs.first];
-                    int  q_ft;
+    /* Calls `f(value)` for the sweep columns of the last document. */
+    template <class F>
+    void visit_sweep(F &&f) const {
+        for (size_t w = 1; w < m_bigram_values.size(); ++w) {
+            f(m_bigram_values[w]);
+        }
+        for (size_t w = 1; w < m_tp_values.size(); ++w) {
+            f(m_tp_values[w]);
+        }
+    }
 
-                    q_ft = 0;
-                    {
-                        auto it = query.q_ft.find(lhs.first);
-                        if (it != query.q_ft.end()) {
-                            q_ft = it->second;
-                        }
-                    }
-                    score += ranker.score(q_ft, data_a.f_dt, data_a.total_term_docs, doc_length);
+    /*
+     * Walks the positions of all slots in document order, a k-way merge of the sorted position
+     * lists, and adds the bigram scores of both terms of every pair of neighbouring positions of
+     * different terms to each window holding the pair: at most `window - 1` apart, and the earlier
+     * term first in the query for an ordered window.
+     */
+    void bigram_window_scores(const int doc_length) {
+        m_bigram_scores.assign(m_terms.size(), -1.0);
+        m_cursors.resize(m_terms.size());
+        for (size_t s = 0; s < m_terms.size(); ++s) {
+            m_cursors[s] = m_terms[s].positions.begin();
+        }
 
-                    q_ft = 0;
-                    {
-                        auto it = query.q_ft.find(rhs.first);
-                        if (it != query.q_ft.end()) {
-                            q_ft = it->second;
+        size_t   prev_slot = m_terms.size();
+        uint32_t prev_pos  = 0;
+        while (true) {
+            size_t slot = m_terms.size();
+            for (size_t s = 0; s < m_terms.size(); ++s) {
+                if (m_cursors[s] != m_terms[s].positions.end() &&
+                    (slot == m_terms.size() || *m_cursors[s] < *m_cursors[slot])) {
+                    slot = s;
+                }
+            }
+            if (slot == m_terms.size()) {
+                break;
+            }
+            uint32_t pos = *m_cursors[slot]++;
+
+            // Skip bigrams with the same term
+            if (prev_slot != m_terms.size() && m_terms[prev_slot].tid != m_terms[slot].tid) {
+                const int dist = (int)pos - (int)prev_pos;
+                if (dist > 0 && dist <= m_max_window) {
+                    bool in_order = m_terms[prev_slot].query_pos < m_terms[slot].query_pos;
+                    for (size_t w = 0; w < m_windows.size(); ++w) {
+                        auto &window = m_windows[w];
+                        if (dist <= window.window - 1 && (in_order || !window.ordered)) {
+                            m_bigram_values[w] += bigram_score(prev_slot, doc_length);
+                            m_bigram_values[w] += bigram_score(slot, doc_length);
                         }
                     }
-                    score += ranker.score(q_ft, data_b.f_dt, data_b.total_term_docs, doc_length);
-                    found.emplace_back(ty, dist, lhs, rhs, score);
                 }
             }
+            prev_slot = slot;
+            prev_pos  = pos;
         }
     }
 
     /**
-     * Bigram interval score. Based on Lu, et al. Efficient and Effective Higher
-     * Order Proximity Modeling, ICTIR 2016.
+     * Bigram interval score of every window size. Based on Lu, et al. Efficient and Effective
+     * Higher Order Proximity Modeling, ICTIR 2016.
      */
-    double tp_interval_score(const std::vector<indri::utility::greedy_vector<int>> &acc_positons,
-                             const std::vector<term_data> &                         acc_terms,
-                             const int                                              wsize,
-                             const double                                           W_d) {
-        double                    doc_score = 0.0;
-        std::pair<double, double> curr_score;
-        double                    lambda_o = 0.4;
-        double                    lambda_u = 0.4;
-
-        for (size_t i = 0; i < acc_positons.size() - 1; ++i) {
-            term_data                          term_i     = acc_terms[i];
-            indri::utility::greedy_vector<int> i_position = acc_positons[i];
-            for (size_t j = (i + 1); j < acc_positons.size(); ++j) {
+    void tp_interval_scores(const double W_d) {
+        double lambda_o = 0.4;
+        double lambda_u = 0.4;
+
+        for (size_t i = 0; i < m_by_freq.size() - 1; ++i) {
+            const term_data &term_i = m_terms[m_by_freq[i]];
+            for (size_t j = (i + 1); j < m_by_freq.size(); ++j) {
                 //!< do the sweep only when bigrams are formed
-                term_data term_j      = acc_terms[j];
-                int       delta_order = term_j.query_pos - term_i.query_pos;
-                if (std::abs(delta_order) == 1) {
-                    indri::utility::greedy_vector<int> j_position = acc_positons[j];
-                    if (delta_order > 0) {
-                        curr_score = TPDist::calc_tp_dist(
-                            i_position, j_position, term_i.w_q, term_j.w_q, wsize);
-                    } else {
-                        curr_score = TPDist::calc_tp_dist(
-                            j_position, i_position, term_j.w_q, term_i.w_q, wsize);
-                    }
-                    curr_score.first = lambda_o * ranker.calculate_tf_score(curr_score.first, W_d);
-                    curr_score.second =
-                        lambda_u * ranker.calculate_tf_score(curr_score.second, W_d);
-                    doc_score += curr_score.first;
-                    doc_score += curr_score.second;
+                const term_data &term_j      = m_terms[m_by_freq[j]];
+                int              delta_order = term_j.query_pos - term_i.query_pos;
+                if (std::abs(delta_order) != 1) {
+                    continue;
+                }
+                const term_data &lhs = delta_order > 0 ? term_i : term_j;
+                const term_data &rhs = delta_order > 0 ? term_j : term_i;
+                TPDist::calc_tp_dist(lhs.positions,
+                                     rhs.positions,
+                                     lhs.w_q,
+                                     rhs.w_q,
+                                     m_tp_windows,
+                                     m_tp_scores,
+                                     m_tp_prev);
+                for (size_t w = 0; w < m_tp_windows.size(); ++w) {
+                    auto &curr_score = m_tp_scores[w];
+                    m_tp_values[w] += lambda_o * ranker.calculate_tf_score(curr_score.first, W_d);
+                    m_tp_values[w] += lambda_u * ranker.calculate_tf_score(curr_score.second, W_d);
                 }
             }
         }
-
-        return doc_score;
     }
 
     /**
-     * Vector insert ordered by f_dt. Xiaolu, et al.
+     * Adds a slot, inserted in `m_by_freq` ordered by f_dt. Xiaolu, et al.
      */
-    void _acc_positions_insert(std::vector<indri::utility::greedy_vector<int>> &pos_vec,
-                               const std::vector<uint32_t> &                          pos_el,
-                               std::vector<term_data> &                         term_vec,
-                               term_data &                                      term_el) {
-
-        if (pos_vec.empty()) {
-            pos_vec.push_back(pos_el);
-            term_vec.push_back(term_el);
-            return;
-        }
-
-        auto pos_itr  = pos_vec.begin();
-        auto term_itr = term_vec.begin();
-        while (pos_el.size() > pos_itr->size() && pos_itr != pos_vec.end()) {
+    void _acc_positions_insert(const term_data &term_el) {
+        m_terms.push_back(term_el);
+        auto itr = m_by_freq.begin();
+        while (itr != m_by_freq.end() &&
+               term_el.positions.size() > m_terms[*itr].positions.size()) {
             //!< if current freq is larger than the previous ones
-            ++pos_itr;
-            ++term_itr;
+            ++itr;
         }
-        pos_vec.insert(pos_itr, pos_el);
-        term_vec.insert(term_itr, term_el);
+        m_by_freq.insert(itr, m_terms.size() - 1);
     }
-
-
 };
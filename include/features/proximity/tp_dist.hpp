@@ -1,6 +1,21 @@
 #pragma once
+#include <cstdint>
+#include <utility>
 #include <vector>
 
+/* Sorted positions of a term in a document, read in place from the forward index. */
+struct PosSpan {
+    const uint32_t *first = nullptr;
+    const uint32_t *last  = nullptr;
+
+    PosSpan() = default;
+    PosSpan(const std::vector<uint32_t> &v) : first(v.data()), last(v.data() + v.size()) {}
+
+    const uint32_t *begin() const { return first; }
+    const uint32_t *end() const { return last; }
+    size_t          size() const { return last - first; }
+};
+
 struct TermPos {
     TermPos() = default;
 
@@ -15,17 +30,39 @@ struct TermPos {
  */
 class TPDist {
    public:
-    static std::pair<double, double> calc_tp_dist(const indri::utility::greedy_vector<int> &pos_i,
-                                                  const indri::utility::greedy_vector<int> &pos_j,
-                                                  const double                              w_i,
-                                                  const double                              w_j,
-                                                  int                                       wsize) {
-        std::pair<double, double>                          dist_scores(0.0, 0.0);
-        std::pair<uint64_t, uint64_t>                      prev_rhs(0, 0);
-        indri::utility::greedy_vector<int>::const_iterator curr_itrs[] = {pos_i.begin(),
-                                                                          pos_j.begin()};
-        indri::utility::greedy_vector<int>::const_iterator end_itrs[]  = {pos_i.end(), pos_j.end()};
-        TermPos                                            lhs, rhs;
+    static std::pair<double, double> calc_tp_dist(const PosSpan &pos_i,
+                                                  const PosSpan &pos_j,
+                                                  const double   w_i,
+                                                  const double   w_j,
+                                                  int            wsize) {
+        std::vector<int>                           wsizes(1, wsize);
+        std::vector<std::pair<double, double>>     dist_scores;
+        std::vector<std::pair<uint64_t, uint64_t>> prev_rhs;
+        calc_tp_dist(pos_i, pos_j, w_i, w_j, wsizes, dist_scores, prev_rhs);
+        return dist_scores[0];
+    };
+
+    /*
+     * The scores of every window size of `wsizes` in one walk over the positions, those of
+     * `wsizes[w]` in `dist_scores[w]`. `prev_rhs` is scratch space kept by the caller.
+     */
+    static void calc_tp_dist(const PosSpan &                             pos_i,
+                             const PosSpan &                             pos_j,
+                             const double                                w_i,
+                             const double                                w_j,
+                             const std::vector<int> &                    wsizes,
+                             std::vector<std::pair<double, double>> &    dist_scores,
+                             std::vector<std::pair<uint64_t, uint64_t>> &prev_rhs) {
+        dist_scores.assign(wsizes.size(), std::make_pair(0.0, 0.0));
+        prev_rhs.assign(wsizes.size(), std::make_pair(0, 0));
+        auto acc_dist = [&](const TermPos &lhs, const TermPos &rhs) {
+            for (size_t w = 0; w < wsizes.size(); ++w) {
+                _acc_dist(lhs, rhs, w_i, w_j, dist_scores[w], prev_rhs[w], wsizes[w]);
+            }
+        };
+        const uint32_t *curr_itrs[] = {pos_i.begin(), pos_j.begin()};
+        const uint32_t *end_itrs[]  = {pos_i.end(), pos_j.end()};
+        TermPos         lhs, rhs;
         lhs.m_order       = *curr_itrs[0] < *curr_itrs[1] ? 0 : 1;
         rhs.m_order       = lhs.m_order == 1 ? 0 : 1;
         lhs.m_pos         = *curr_itrs[lhs.m_order];
@@ -36,12 +73,12 @@ class TPDist {
             ++curr_itrs[lhs.m_order];
             if (curr_itrs[lhs.m_order] == end_itrs[lhs.m_order]) {
                 //!< we can finish it
-                _acc_dist(lhs, rhs, w_i, w_j, dist_scores, prev_rhs, wsize);
+                acc_dist(lhs, rhs);
                 break;
             }
             next_pos = *(curr_itrs[lhs.m_order]);
             if (next_pos > rhs.m_pos) {
-                _acc_dist(lhs, rhs, w_i, w_j, dist_scores, prev_rhs, wsize);
+                acc_dist(lhs, rhs);
                 tmp = TermPos(lhs.m_order, next_pos);
                 lhs = rhs;
                 rhs = tmp;
@@ -49,8 +86,7 @@ class TPDist {
                 lhs.m_pos = next_pos;
             }
         }
-        return dist_scores;
-    };
+    }
 
    protected:
     static void _acc_dist(TermPos                        lhs,
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "query_doc_view.hpp"
+
+/**
+ * Candidate documents of one query in struct-of-arrays layout: one column per query term and
+ * scored field, with one entry per document, so a model is evaluated with plain loops over
+ * contiguous doubles. Columns keep their capacity across batches, and the columns of a longer
+ * query are kept for the next one.
+ *
+ * A batch may also carry length normalisations precomputed for each document, column
+ * `batch_scorer::column(m, scope)` holding those of model m.
+ */
+class query_doc_batch {
+   public:
+    static constexpr size_t fields = query_doc_view::scored_field_count;
+
+   private:
+    size_t                                  m_size = 0;
+    std::vector<uint64_t>                   m_tids;
+    std::vector<int>                        m_qf;
+    std::array<int, fields>                 m_field_ids;
+    std::vector<double>                     m_len;
+    std::array<std::vector<double>, fields> m_field_len;
+    std::vector<std::vector<double>>        m_tf;
+    // term t, field f is column t * fields + f
+    std::vector<std::vector<double>>        m_field_tf;
+    size_t                                  m_norm_columns = 0;
+    std::vector<std::vector<double>>        m_norms;
+
+   public:
+    void clear() { m_size = 0; }
+
+    /* Room for `docs` documents of queries of up to `terms` terms, with `norms` normalisations. */
+    void reserve(size_t docs, size_t terms, size_t norms = 0) {
+        m_tids.reserve(terms);
+        m_qf.reserve(terms);
+        m_len.reserve(docs);
+        for (auto &&column : m_field_len) {
+            column.reserve(docs);
+        }
+        if (m_tf.size() < terms) {
+            m_tf.resize(terms);
+            m_field_tf.resize(terms * fields);
+        }
+        for (auto &&column : m_tf) {
+            column.reserve(docs);
+        }
+        for (auto &&column : m_field_tf) {
+            column.reserve(docs);
+        }
+        if (m_norms.size() < norms) {
+            m_norms.resize(norms);
+        }
+        for (auto &&column : m_norms) {
+            column.reserve(docs);
+        }
+    }
+
+    /*
+     * Appends a document with the `columns` normalisations `norms`, if any; every view of a batch
+     * is gathered for the same query and comes with as many normalisations.
+     */
+    void add(const query_doc_view &view, const double *norms = nullptr, size_t columns = 0) {
+        auto &terms = view.terms();
+        if (m_size == 0) {
+            m_tids.clear();
+            m_qf.clear();
+            for (auto &&t : terms) {
+                m_tids.push_back(t.tid);
+                m_qf.push_back(t.qf);
+            }
+            m_len.clear();
+            for (size_t f = 0; f < fields; ++f) {
+                m_field_ids[f] = view.field_at(f).id;
+                m_field_len[f].clear();
+            }
+            if (m_tf.size() < terms.size()) {
+                m_tf.resize(terms.size());
+                m_field_tf.resize(terms.size() * fields);
+            }
+            for (auto &&column : m_tf) {
+                column.clear();
+            }
+            for (auto &&column : m_field_tf) {
+                column.clear();
+            }
+            m_norm_columns = columns;
+            if (m_norms.size() < columns) {
+                m_norms.resize(columns);
+            }
+            for (auto &&column : m_norms) {
+                column.clear();
+            }
+        }
+
+        m_len.push_back(view.length());
+        for (size_t f = 0; f < fields; ++f) {
+            m_field_len[f].push_back(view.field_at(f).len);
+        }
+        for (size_t t = 0; t < terms.size(); ++t) {
+            m_tf[t].push_back(terms[t].tf);
+            for (size_t f = 0; f < fields; ++f) {
+                m_field_tf[t * fields + f].push_back(terms[t].field_tf[f]);
+            }
+        }
+        for (size_t c = 0; c < m_norm_columns; ++c) {
+            m_norms[c].push_back(norms[c]);
+        }
+        ++m_size;
+    }
+
+    size_t size() const { return m_size; }
+    size_t terms() const { return m_tids.size(); }
+
+    uint64_t tid(size_t t) const { return m_tids[t]; }
+    int      qf(size_t t) const { return m_qf[t]; }
+    int      field_id(size_t f) const { return m_field_ids[f]; }
+
+    const double *len() const { return m_len.data(); }
+    const double *field_len(size_t f) const { return m_field_len[f].data(); }
+    const double *tf(size_t t) const { return m_tf[t].data(); }
+    const double *field_tf(size_t t, size_t f) const { return m_field_tf[t * fields + f].data(); }
+    /* Precomputed normalisations of column c, nullptr if the batch has none. */
+    const double *norm(size_t c) const { return c < m_norm_columns ? m_norms[c].data() : nullptr; }
+};
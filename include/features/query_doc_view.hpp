@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "field_id.hpp"
+#include "forward_index.hpp"
+#include "query_train_file.hpp"
+
+/**
+ * A document projected onto the terms of one query. `gather` does every map lookup the feature
+ * extractors need once per query term and field, and the extractors then only read this view.
+ */
+class query_doc_view {
+   public:
+    /* Field slots, the first `scored_field_count` are scored by the retrieval models. */
+    enum slot : size_t { body, title, heading, inlink, a, mainbody, applet, object, embed };
+
+    static constexpr size_t field_count        = embed + 1;
+    static constexpr size_t scored_field_count = a + 1;
+    // per-term frequencies are only read for the scored fields and mainbody
+    static constexpr size_t tf_field_count     = mainbody + 1;
+
+    struct term {
+        uint64_t                             tid;
+        int                                  qf;
+        uint32_t                             tf;
+        std::array<uint32_t, tf_field_count> field_tf;
+        const std::vector<uint32_t> *        positions;
+    };
+
+    struct field {
+        int      id           = 0;
+        uint16_t tag_count    = 0;
+        uint16_t len          = 0;
+        uint16_t min_len      = 0;
+        uint16_t max_len      = 0;
+        uint32_t len_sum_sqrs = 0;
+    };
+
+   private:
+    std::array<field, field_count> m_fields;
+    std::vector<term>              m_terms;
+    const query_train *            m_qry = nullptr;
+    const Document *               m_doc = nullptr;
+
+    static const std::vector<uint32_t> &no_positions() {
+        static const std::vector<uint32_t> empty;
+        return empty;
+    }
+
+   public:
+    static const std::array<std::string, field_count> &names() {
+        static const std::array<std::string, field_count> names = {
+            {"body", "title", "heading", "inlink", "a", "mainbody", "applet", "object", "embed"}};
+        return names;
+    }
+
+    /* Field ids are resolved once, a field missing from the map keeps id 0. */
+    explicit query_doc_view(const FieldIdMap &field_id_map) {
+        for (size_t f = 0; f < field_count; ++f) {
+            m_fields[f].id = find_field_id(field_id_map, names()[f]);
+        }
+    }
+
+    /* Terms are kept in `qry.q_ft` order, so sums over them match a loop over `q_ft`. */
+    void gather(const query_train &qry, const Document &doc) {
+        m_qry = &qry;
+        m_doc = &doc;
+        for (auto &&f : m_fields) {
+            auto stats     = doc.field_stats(f.id);
+            f.tag_count    = stats ? stats->tag_count() : 0;
+            f.len          = stats ? stats->field_len() : 0;
+            f.min_len      = stats ? stats->field_min_len() : 0;
+            f.max_len      = stats ? stats->field_max_len() : 0;
+            f.len_sum_sqrs = stats ? stats->field_len_sum_sqrs() : 0;
+        }
+
+        m_terms.resize(qry.q_ft.size());
+        size_t i = 0;
+        for (auto &&q : qry.q_ft) {
+            auto &t     = m_terms[i++];
+            auto  stats = doc.term_stats(q.first);
+            t.tid       = q.first;
+            t.qf        = q.second;
+            t.tf        = stats ? stats->freq() : 0;
+            t.positions = stats ? &stats->positions() : &no_positions();
+            for (size_t f = 0; f < tf_field_count; ++f) {
+                t.field_tf[f] = stats ? stats->freq(m_fields[f].id) : 0;
+            }
+        }
+    }
+
+    void reserve(size_t terms) { m_terms.reserve(terms); }
+
+    const std::vector<term> &terms() const { return m_terms; }
+
+    /* nullptr for a term that is not in the query. */
+    const term *find(uint64_t tid) const {
+        for (auto &&t : m_terms) {
+            if (t.tid == tid) {
+                return &t;
+            }
+        }
+        return nullptr;
+    }
+
+    const field &field_at(size_t f) const { return m_fields[f]; }
+
+    const query_train &query() const { return *m_qry; }
+
+    uint32_t length() const { return m_doc->length(); }
+
+    const Document &document() const { return *m_doc; }
+};
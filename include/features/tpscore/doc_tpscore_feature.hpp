@@ -1,14 +1,22 @@
 #pragma once
 
 #include <cmath>
+#include <vector>
 
-#include "features/bm25/doc_bm25_feature.hpp"
+#include "doc_entry.hpp"
+#include "lexicon.hpp"
+#include "query_train_file.hpp"
+
+#include "features/bm25/bm25.hpp"
+#include "features/query_doc_view.hpp"
 
 struct bctp_term {
-    int    id;
-    double weight      = 0.0;
-    double accumulator = 0.0;
-    int    doc_count   = 0;
+    int                          id;
+    double                       weight      = 0.0;
+    double                       accumulator = 0.0;
+    // positions of the term in the document and the next one to merge
+    const std::vector<uint32_t> *positions = nullptr;
+    size_t                       next      = 0;
 };
 
 struct bctp_scorer {
@@ -17,18 +25,14 @@ struct bctp_scorer {
     double b           = 0.4;
     double avg_doc_len = 0.0;
 
-    double score(std::vector<bctp_term> &terms, doc_entry &doc, Document &doc_idx) {
+    double score(std::vector<bctp_term> &terms, const doc_entry &doc) {
         double score = 0.0;
 
         if (terms.size() < 3 || doc.length < terms.size()) {
             return score;
         }
 
-        std::map<int, bctp_term *> term_map;
-        for (auto &t : terms) {
-            term_map.insert(std::make_pair(t.id, &t));
-        }
-        score_terms(term_map, doc_idx.terms());
+        score_terms(terms);
 
         for (auto const &term : terms) {
             double weight = std::min(1.0, term.weight);
@@ -42,26 +46,38 @@ struct bctp_scorer {
         return score;
     }
 
-    void score_terms(std::map<int, bctp_term *> &terms, const std::vector<uint32_t> &doc_positions) {
+    /*
+     * Visits the query term occurrences in document order, a merge of the position lists of the
+     * terms, so the cost follows the occurrences rather than the document length.
+     */
+    void score_terms(std::vector<bctp_term> &terms) {
         bctp_term *curr_term = nullptr;
         bctp_term *prev_term = nullptr;
         size_t     prev_pos  = 0;
 
         for (auto &t : terms) {
-            t.second->weight = rw_idf_weight(t.second->doc_count);
+            t.next = 0;
         }
 
-        for (size_t pos = 0; pos < doc_positions.size(); ++pos) {
-            int term_id = doc_positions[pos];
-            if (terms.count(term_id) == 1) {
-                curr_term = terms[term_id];
-                if (prev_term && prev_term->id != curr_term->id) {
-                    curr_term->accumulator += prev_term->weight * distance(pos, prev_pos);
-                    prev_term->accumulator += curr_term->weight * distance(pos, prev_pos);
+        while (true) {
+            size_t pos = 0;
+            curr_term  = nullptr;
+            for (auto &t : terms) {
+                if (t.next < t.positions->size() && (!curr_term || (*t.positions)[t.next] < pos)) {
+                    curr_term = &t;
+                    pos       = (*t.positions)[t.next];
                 }
-                prev_term = curr_term;
-                prev_pos  = pos;
             }
+            if (!curr_term) {
+                break;
+            }
+            ++curr_term->next;
+            if (prev_term && prev_term->id != curr_term->id) {
+                curr_term->accumulator += prev_term->weight * distance(pos, prev_pos);
+                prev_term->accumulator += curr_term->weight * distance(pos, prev_pos);
+            }
+            prev_term = curr_term;
+            prev_pos  = pos;
         }
     }
 
@@ -75,36 +91,74 @@ struct bctp_scorer {
     inline double distance(size_t pos_i, size_t pos_j) { return std::pow(pos_j - pos_i, -2); }
 };
 
-class doc_tpscore_feature : public doc_bm25_feature {
-    bctp_scorer ranker_bctp;
+/* The TP-Score of a document, its BM25 Atire plus its BCTP proximity score. */
+class doc_tpscore_feature {
+    Lexicon &              lexicon;
+    rank_bm25              ranker;
+    bctp_scorer            ranker_bctp;
+    std::vector<bctp_term> bctp_query;
+    // BCTP and BM25 weights of the terms of the query of `prepare`, in `q_ft` order
+    std::vector<double>    m_bctp_weights;
+    std::vector<double>    m_bm25_weights;
 
    public:
-    doc_tpscore_feature(Lexicon &lex) : doc_bm25_feature(lex) {
-        ranker_bctp.num_docs    = _num_docs;
-        ranker_bctp.avg_doc_len = _avg_doc_len;
+    doc_tpscore_feature(Lexicon &lex) : lexicon(lex) {
+        uint64_t num_docs       = lexicon.document_count();
+        double   avg_doc_len    = (double)lexicon.term_count() / num_docs;
+        ranker.num_docs         = num_docs;
+        ranker.avg_doc_len      = avg_doc_len;
+        ranker_bctp.num_docs    = num_docs;
+        ranker_bctp.avg_doc_len = avg_doc_len;
+        ranker.set_k1(90);
+        ranker.set_b(40);
+    }
+
+    /* Room for queries of up to `terms` terms. */
+    void reserve(size_t terms) {
+        bctp_query.reserve(terms);
+        m_bctp_weights.reserve(terms);
+        m_bm25_weights.reserve(terms);
+    }
+
+    /* Computes the weights of the terms of `query`, before any of its documents. */
+    void prepare(const query_train &query) {
+        m_bctp_weights.clear();
+        m_bm25_weights.clear();
+        for (auto &q : query.q_ft) {
+            bool   oov       = lexicon.is_oov(q.first);
+            size_t doc_count = oov ? 0 : lexicon[q.first].document_count();
+            m_bctp_weights.push_back(oov ? 0.0 : ranker_bctp.rw_idf_weight(doc_count));
+            m_bm25_weights.push_back(oov ? 0.0 : ranker.calculate_idf(q.second, doc_count));
+        }
     }
 
-    void compute(query_train &qry, doc_entry &doc, Document &doc_idx, FieldIdMap &field_id_map) {
-        auto bm25_atire = doc.bm25_atire;
-        if(bm25_atire == 0) {
-            ranker.set_k1(90);
-            ranker.set_b(40);
-            bm25_compute(qry, doc, doc_idx, field_id_map);
-            bm25_atire = _score_doc;
+    void compute(doc_entry &doc, const query_doc_view &view) {
+        auto &terms      = view.terms();
+        auto  bm25_atire = doc.bm25_atire;
+        if (bm25_atire == 0) {
+            // the BM25 Atire of the document, when it was not extracted
+            for (size_t j = 0; j < terms.size(); ++j) {
+                auto &t = terms[j];
+                if (lexicon.is_oov(t.tid) || t.tf == 0) {
+                    continue;
+                }
+                bm25_atire += ranker.calculate_tf_score(t.tf, doc.length) * m_bm25_weights[j];
+            }
         }
 
-        std::vector<bctp_term> bctp_query;
-        for (auto &q : qry.q_ft) {
+        bctp_query.clear();
+        for (size_t j = 0; j < terms.size(); ++j) {
             bctp_term t;
-            if (lexicon.is_oov(q.first)) {
+            if (lexicon.is_oov(terms[j].tid)) {
                 continue;
             }
-            t.id        = q.first;
-            t.doc_count = lexicon[q.first].document_count();
+            t.id        = terms[j].tid;
+            t.weight    = m_bctp_weights[j];
+            t.positions = terms[j].positions;
             bctp_query.push_back(t);
         }
 
-        double tp_score = ranker_bctp.score(bctp_query, doc, doc_idx);
+        double tp_score = ranker_bctp.score(bctp_query, doc);
         // The TP-Score is BM25 + BCTP
         doc.tpscore = bm25_atire + tp_score;
     }
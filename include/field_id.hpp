@@ -1,5 +1,45 @@
 #pragma once
 
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
 #include <string>
 
 using FieldIdMap = std::map<std::string, int>;
+
+/* Read-only lookup, 0 for a field that is not indexed. */
+inline int find_field_id(const FieldIdMap &field_id_map, const std::string &field) {
+    auto it = field_id_map.find(field);
+    if (it == field_id_map.end()) {
+        return 0;
+    }
+    return it->second;
+}
+
+/* Field ids written by `create_forward_index`, one `name id` pair per line. */
+inline FieldIdMap read_field_manifest(const std::string &path) {
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        std::cerr << "Could not open file: " << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    FieldIdMap  field_id_map;
+    std::string name;
+    int         id;
+    while (ifs >> name >> id) {
+        field_id_map[name] = id;
+    }
+    return field_id_map;
+}
+
+inline void write_field_manifest(const std::string &path, const FieldIdMap &field_id_map) {
+    std::ofstream ofs(path);
+    if (!ofs.is_open()) {
+        std::cerr << "Could not open file: " << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (auto &&field : field_id_map) {
+        ofs << field.first << " " << field.second << "\n";
+    }
+}
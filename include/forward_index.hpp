@@ -120,6 +120,18 @@ public:
         return m_term_stats.at(term).freq();
     }
 
+    /* nullptr if the term does not occur in the document. */
+    const TermStats *term_stats(uint32_t term) const {
+        auto it = m_term_stats.find(term);
+        return it == m_term_stats.end() ? nullptr : &it->second;
+    }
+
+    /* nullptr if the field does not occur in the document. */
+    const Field *field_stats(uint16_t field_id) const {
+        auto it = m_field_stats.find(field_id);
+        return it == m_field_stats.end() ? nullptr : &it->second;
+    }
+
     std::vector<uint32_t> positions(uint32_t term) const {
         if (m_term_stats.find(term) == m_term_stats.end()) {
             return {};
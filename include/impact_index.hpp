@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+
+#include "codecfactory.h"
+#include "deltautil.h"
+
+#include "doc_lens.hpp"
+#include "inverted_index.hpp"
+#include "lexicon.hpp"
+#include "score_bounds.hpp"
+
+/* Postings of a term sharing one quantised impact, documents in increasing order. */
+struct ImpactSegment {
+
+    IntegerCODEC &codec = *CODECFactory::getFromName("simdfastpfor256");
+
+    uint32_t              impact = 0;
+    uint32_t              m_size = 0;
+    std::vector<uint32_t> m_docs;
+
+    uint32_t size() const { return m_size; }
+
+    void add_docs(std::vector<uint32_t> &docs) {
+        m_size = docs.size();
+        // room for the codec headers of short segments
+        m_docs.resize(m_size * 2 + 1024);
+
+        size_t compressedsize = m_docs.size();
+        Delta::deltaSIMD(docs.data(), docs.size());
+        codec.encodeArray(docs.data(), docs.size(), m_docs.data(), compressedsize);
+        m_docs.resize(compressedsize);
+        m_docs.shrink_to_fit();
+    }
+
+    std::vector<uint32_t> docs() {
+        std::vector<uint32_t> docs;
+        decode(docs);
+        return docs;
+    }
+
+    /* Decodes the documents into `docs`, whose capacity is kept for the next segment. */
+    void decode(std::vector<uint32_t> &docs) {
+        docs.resize(m_size);
+        size_t recoveredsize = docs.size();
+        codec.decodeArray(m_docs.data(), m_docs.size(), docs.data(), recoveredsize);
+        docs.resize(recoveredsize);
+        Delta::inverseDeltaSIMD(docs.data(), docs.size());
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(impact, m_size, m_docs);
+    }
+};
+
+/* Segments of a term by decreasing impact. */
+struct ImpactList {
+    std::string                term;
+    std::vector<ImpactSegment> segments;
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(term, segments);
+    }
+};
+
+/**
+ * Impact-ordered copy of an `InvertedIndex` for score-at-a-time retrieval. The BM25 score of
+ * every posting, its factor times the term weight at query frequency 1, is quantised linearly to
+ * `bits` bits over the largest score of the index: impact i stands for a score of about i * scale,
+ * and every posting gets an impact of at least 1.
+ */
+struct ImpactIndex {
+    BM25Params              bm25;
+    uint32_t                bits    = 8;
+    double                  scale   = 0;
+    uint32_t                max_doc = 0;
+    std::vector<ImpactList> lists;
+
+    void build(InvertedIndex &inv_idx, const DocLens &doc_lens, const Lexicon &lexicon) {
+        bm25.set_collection(lexicon);
+        auto scores = [&](PostingList &pl, std::vector<uint32_t> &docs) {
+            auto                list   = pl.list();
+            double              weight = bm25.weight(1, pl.size());
+            std::vector<double> s(list.first.size());
+            for (size_t i = 0; i < s.size(); ++i) {
+                s[i] = bm25.factor(list.second[i], bm25.norm(doc_lens[list.first[i]])) * weight;
+            }
+            docs = std::move(list.first);
+            return s;
+        };
+
+        double                max_score = 0;
+        std::vector<uint32_t> docs;
+        for (auto &&pl : inv_idx) {
+            for (double s : scores(pl, docs)) {
+                max_score = std::max(max_score, s);
+            }
+            if (!docs.empty()) {
+                max_doc = std::max(max_doc, docs.back());
+            }
+        }
+        uint32_t levels = (1u << bits) - 1;
+        scale           = max_score > 0 ? max_score / levels : 1;
+
+        lists.clear();
+        lists.resize(inv_idx.size());
+        std::vector<std::vector<uint32_t>> by_impact(levels + 1);
+        for (size_t t = 0; t < inv_idx.size(); ++t) {
+            lists[t].term = inv_idx[t].term;
+            auto s        = scores(inv_idx[t], docs);
+            for (size_t i = 0; i < s.size(); ++i) {
+                auto q = std::min<long>(levels, std::max(1L, std::lround(s[i] / scale)));
+                by_impact[q].push_back(docs[i]);
+            }
+            for (uint32_t q = levels; q > 0; --q) {
+                if (by_impact[q].empty()) {
+                    continue;
+                }
+                lists[t].segments.emplace_back();
+                lists[t].segments.back().impact = q;
+                lists[t].segments.back().add_docs(by_impact[q]);
+                by_impact[q].clear();
+            }
+        }
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(bm25, bits, scale, max_doc, lists);
+    }
+};
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "cereal/archives/binary.hpp"
 #include "cereal/types/vector.hpp"
 #include "cereal/types/string.hpp"
 
 #include "codecfactory.h"
 #include "deltautil.h"
 #include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
 
 using namespace FastPForLib;
 
@@ -64,4 +68,59 @@ struct PostingList {
     }
 };
 
-using InvertedIndex = std::vector<PostingList>;
\ No newline at end of file
+using InvertedIndex = std::vector<PostingList>;
+/**
+ * Reads the lists of an `InvertedIndex` file one at a time, so a caller wanting a few lists does
+ * not deserialize the others: `next` reads the term of the next list, whose postings are loaded
+ * by `load` or else skipped. Follows the layout of `cereal::BinaryOutputArchive`, a 64-bit size
+ * before each string and vector and arithmetic values as they are.
+ */
+class InvertedIndexReader {
+    std::ifstream              m_is;
+    cereal::BinaryInputArchive m_archive;
+    uint64_t                   m_lists   = 0;
+    uint64_t                   m_read    = 0;
+    bool                       m_pending = false;
+    std::string                m_term;
+
+    void skip_vector(size_t value_size) {
+        uint64_t n = 0;
+        m_archive(n);
+        m_is.seekg(n * value_size, std::ios::cur);
+    }
+
+   public:
+    explicit InvertedIndexReader(const std::string &file) : m_is(file), m_archive(m_is) {
+        if (!m_is.is_open()) {
+            std::cerr << "Could not open file: " << file << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_archive(m_lists);
+    }
+
+    uint64_t size() const { return m_lists; }
+
+    /* Reads the term of the next list into `term`, false after the last list. */
+    bool next(std::string &term) {
+        if (m_pending) {
+            m_is.seekg(sizeof(uint32_t) * 2, std::ios::cur);
+            skip_vector(sizeof(uint32_t));
+            skip_vector(sizeof(uint32_t));
+        }
+        m_pending = m_read < m_lists;
+        if (!m_pending) {
+            return false;
+        }
+        ++m_read;
+        m_archive(m_term);
+        term = m_term;
+        return true;
+    }
+
+    /* Loads the list whose term `next` read. */
+    void load(PostingList &pl) {
+        pl.term = m_term;
+        m_archive(pl.totalCount, pl.m_size, pl.m_docs, pl.m_freqs);
+        m_pending = false;
+    }
+};
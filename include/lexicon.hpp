@@ -67,7 +67,9 @@ class Lexicon {
     inline const Term &operator[](size_t pos) const { return terms[pos]; }
     inline Term &      operator[](size_t pos) { return terms[pos]; }
 
-    inline size_t term(const std::string& t) {
+    inline size_t size() const { return terms.size(); }
+
+    inline size_t term(const std::string& t) const {
         auto it = term_id.find(t);
         if(it != term_id.end()){
             return it->second;
@@ -75,9 +77,9 @@ class Lexicon {
         return oov_term();
     }
 
-    inline size_t oov_term() { return std::numeric_limits<std::size_t>::max(); }
+    inline size_t oov_term() const { return std::numeric_limits<std::size_t>::max(); }
 
-    inline bool is_oov(size_t tid) { return tid == oov_term(); }
+    inline bool is_oov(size_t tid) const { return tid == oov_term(); }
 
     void push_back(const std::string &t, const Counts &c, const FieldCounts &fc) {
         auto id = terms.size();
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Document rows in the NumPy `.npy` format: one packed record per document with `label` and
+ * `qid` as int32, `docno` as a fixed-width byte string and one float32 or float64 field per
+ * feature, named after it. `np.load(path, mmap_mode='r')` maps the rows without parsing them.
+ *
+ * Values are stored in host byte order and described as little-endian.
+ */
+class npy_layout {
+    // the row count is rewritten once all rows are known, in a field of fixed width
+    static constexpr size_t shape_width = 20;
+
+    size_t      m_value_size;
+    size_t      m_docno_width;
+    size_t      m_features;
+    std::string m_descr;
+
+    template <class T>
+    static void append_value(std::string &out, T value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+   public:
+    /* `value_size` is 4 or 8, docnos up to `docno_len` characters fit in a record. */
+    npy_layout(const std::vector<std::string> &names, size_t value_size, size_t docno_len)
+        : m_value_size(value_size),
+          // keeps the feature values of a record aligned
+          m_docno_width(std::max<size_t>(8, (docno_len + 7) / 8 * 8)),
+          m_features(names.size()) {
+        std::string type = value_size == 4 ? "'<f4'" : "'<f8'";
+        m_descr          = "[('label', '<i4'), ('qid', '<i4'), ";
+        m_descr += "('docno', 'S" + std::to_string(m_docno_width) + "')";
+        for (auto &&name : names) {
+            m_descr += ", ('" + name + "', " + type + ")";
+        }
+        m_descr += "]";
+    }
+
+    size_t record_size() const { return 8 + m_docno_width + m_features * m_value_size; }
+
+    /* Header of a file of `rows` records, its length does not depend on `rows`. */
+    std::string header(size_t rows) const {
+        std::string shape = std::to_string(rows);
+        std::string dict  = "{'descr': " + m_descr + ", 'fortran_order': False, 'shape': (" +
+                           shape + ",), }" + std::string(shape_width - shape.size(), ' ');
+
+        // version 1.0 stores the header length in 16 bits, 2.0 in 32 bits
+        size_t preamble = dict.size() + 64 < 65536 ? 10 : 12;
+        size_t len      = (preamble + dict.size() + 1 + 63) / 64 * 64 - preamble;
+        dict.append(len - dict.size() - 1, ' ');
+        dict.push_back('\n');
+
+        std::string out("\x93NUMPY", 6);
+        out.push_back(preamble == 10 ? 1 : 2);
+        out.push_back(0);
+        for (size_t i = 0; i < preamble - 8; ++i) {
+            out.push_back(static_cast<char>((len >> (8 * i)) & 0xFF));
+        }
+        return out + dict;
+    }
+
+    /* Appends the record of one document, `values` holds one value per feature. */
+    void append(std::string &out, int label, int qid, const std::string &docno,
+                const double *values) const {
+        append_value<int32_t>(out, label);
+        append_value<int32_t>(out, qid);
+        out.append(docno, 0, m_docno_width);
+        out.append(m_docno_width - std::min(docno.size(), m_docno_width), '\0');
+        for (size_t i = 0; i < m_features; ++i) {
+            if (m_value_size == 4) {
+                append_value<float>(out, values[i]);
+            } else {
+                append_value<double>(out, values[i]);
+            }
+        }
+    }
+};
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "preret_stats.hpp"
+#include "query_train_file.hpp"
+#include "stopwords.h"
+#include "term_feature.hpp"
+
+/**
+ * Pre-retrieval query features from unigram and bigram term statistics.
+ *
+ * Unigram statistics are indexed by lexicon term id and bigram statistics by the packed ids of
+ * their two terms. The stopword flags and the statistics are built once and only read by
+ * `compute`, which does lookups and arithmetic into per-thread scratch buffers.
+ */
+class preret_engine {
+    using model = stats_table::model;
+
+    static constexpr double zeta = 1.960;
+
+    std::unordered_set<std::string> m_stopwords;
+    std::vector<char>               m_stop;
+    stats_table                     m_unigrams;
+    stats_table                     m_bigrams;
+    bigram_table                    m_bigram_rows;
+    uint64_t                        m_total_docs;
+    uint64_t                        m_total_terms;
+
+    template <typename Function>
+    static void load_stats(const std::string &file, size_t arity, Function add) {
+        std::ifstream ifs(file);
+        if (!ifs.is_open()) {
+            std::cerr << "Could not open file: " << file << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::string line;
+        feature_t   f;
+        while (std::getline(ifs, line)) {
+            if (parse_feature(line, arity, f) && !add(f)) {
+                std::cerr << "ERROR: Duplicate term <" << f.term << ">!" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    /* Out of vocabulary terms fall back to a string lookup. */
+    bool is_stopword(const query_train &qry, size_t i) const {
+        uint64_t tid = qry.tids[i];
+        return tid < m_stop.size() ? m_stop[tid] : m_stopwords.count(qry.stems[i]) > 0;
+    }
+
+    double idf(size_t tid) const {
+        return (log2(m_total_docs + 0.5) / m_unigrams.cdf(tid)) / log2(m_total_docs + 1);
+    }
+
+    double ictf(size_t tid) const {
+        return (log2(m_total_terms + 0.5) / m_unigrams.cf(tid)) / log2(m_total_terms + 1);
+    }
+
+    /*
+     * Aggregates one scoring model over the matched rows. The rows are visited in decreasing
+     * order of their maximum score so that the sums are accumulated in the historical order.
+     */
+    static double *
+    write_metric(const stats_table &table, model m, bool dph_quirk, std::vector<size_t> &rows,
+                 double *out) {
+        const auto &max_c    = table.column(m, stats_table::max);
+        const auto &avg_c    = table.column(m, stats_table::avg);
+        const auto &hmean_c  = table.column(m, stats_table::hmean);
+        const auto &median_c = table.column(m, stats_table::median);
+        const auto &first_c  = table.column(m, stats_table::first);
+        const auto &third_c  = table.column(m, stats_table::third);
+        const auto &var_c    = table.column(m, stats_table::variance);
+
+        std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+            return max_c[a] > max_c[b];
+        });
+
+        double aimpact = 0.0, amean = 0.0, amedian = 0.0, ahmean = 0.0, avar = 0.0, aiqr = 0.0;
+        double min = DBL_MAX, max = 0.0;
+        double min_mean = DBL_MAX, max_mean = 0.0;
+        double min_hmean = DBL_MAX, max_hmean = 0.0;
+        double min_median = DBL_MAX, max_median = 0.0;
+        double min_fq = DBL_MAX, max_fq = 0.0;
+        double min_tq = DBL_MAX, max_tq = 0.0;
+        double min_var = DBL_MAX, max_var = 0.0;
+
+        for (auto r : rows) {
+            min        = std::min(min, max_c[r]);
+            max        = std::max(max, max_c[r]);
+            min_mean   = std::min(min_mean, avg_c[r]);
+            max_mean   = std::max(max_mean, avg_c[r]);
+            min_hmean  = std::min(min_hmean, hmean_c[r]);
+            max_hmean  = std::max(max_hmean, hmean_c[r]);
+            min_median = std::min(min_median, median_c[r]);
+            max_median = std::max(max_median, median_c[r]);
+            min_fq     = std::min(min_fq, first_c[r]);
+            max_fq     = std::max(max_fq, first_c[r]);
+            min_tq     = std::min(min_tq, third_c[r]);
+            max_tq     = std::max(max_tq, third_c[r]);
+            min_var    = std::min(min_var, var_c[r]);
+            max_var    = std::max(max_var, var_c[r]);
+
+            aimpact += max_c[r];
+            amean += avg_c[r];
+            ahmean += hmean_c[r];
+            amedian += median_c[r];
+            avar += var_c[r];
+            aiqr += (first_c[r] - third_c[r]);
+        }
+        // The unigram DPH block has always reported these minima as zero.
+        if (dph_quirk) {
+            min_mean  = 0;
+            min_hmean = 0;
+            min_var   = 0;
+        }
+
+        size_t tcnt     = rows.size();
+        double values[] = {aimpact / tcnt, amean / tcnt, ahmean / tcnt, amedian / tcnt,
+                           aiqr / tcnt,    avar / tcnt,  min,           max,
+                           min_mean,       max_mean,     min_median,    max_median,
+                           min_hmean,      max_hmean,    min_var,       max_var,
+                           min_fq,         max_fq,       min_tq,        max_tq};
+        return std::copy(std::begin(values), std::end(values), out);
+    }
+
+    /* Term count, document frequency and geometric mean summaries followed by all models. */
+    static double *
+    write_metrics(const stats_table &table, bool unigram, std::vector<size_t> &rows, double *out) {
+        // BM25 comes first and leaves the rows in its order for the sums below
+        double bm25[20];
+        write_metric(table, stats_table::bm25, false, rows, bm25);
+
+        long double acdf    = 0.0;
+        double      agm     = 0.0;
+        uint64_t    cdf_min = UINT64_MAX, cdf_max = 0;
+        double      gm_min = DBL_MAX, gm_max = 0.0;
+        for (auto r : rows) {
+            cdf_min = std::min(cdf_min, table.cdf(r));
+            cdf_max = std::max(cdf_max, table.cdf(r));
+            gm_min  = std::min(gm_min, table.geo_mean(r));
+            gm_max  = std::max(gm_max, table.geo_mean(r));
+            acdf += table.cdf(r);
+            agm += table.geo_mean(r);
+        }
+
+        size_t tcnt = rows.size();
+        *out++      = tcnt;
+        *out++      = rintl(acdf / tcnt);
+        *out++      = agm / tcnt;
+        out         = std::copy(bm25, bm25 + 6, out);
+        *out++      = cdf_min;
+        *out++      = cdf_max;
+        *out++      = gm_min;
+        *out++      = gm_max;
+        out         = std::copy(bm25 + 6, bm25 + 20, out);
+
+        model models[] = {stats_table::tfidf,
+                          stats_table::lm,
+                          stats_table::pr,
+                          stats_table::be,
+                          stats_table::dph,
+                          stats_table::dfr};
+        for (auto m : models) {
+            out = write_metric(table, m, unigram && m == stats_table::dph, rows, out);
+        }
+        return out;
+    }
+
+    /*
+     * Query level predictors over the unigram statistics: stopped length, simplified clarity
+     * score, query scope, gamma1 (IDF spread), gamma2, AvIDF and AvICTF.
+     *
+     * He and Ounis. Inferring Query Performance Using Pre-retrieval Predictors, SPIRE 2004.
+     */
+    double *write_query_features(const query_train &qry, double *out) const {
+        size_t len = qry.tids.size(), len_stopped = 0;
+        for (size_t i = 0; i < len; ++i) {
+            if (!is_stopword(qry, i)) {
+                ++len_stopped;
+            }
+        }
+
+        const auto &tf_min_c = m_unigrams.column(stats_table::tfidf, stats_table::min);
+        const auto &tf_max_c = m_unigrams.column(stats_table::tfidf, stats_table::max);
+
+        uint64_t sum_cdf = 0;
+        double   sum = 0.0, sum_sqrs = 0.0;
+        double   tf_min = DBL_MAX, tf_max = 0.0;
+        double   idf_full = 0.0;
+        double   ictf_stopped = 0.0, ictf_full = 0.0;
+        for (size_t i = 0; i < len; ++i) {
+            uint64_t tid = qry.tids[i];
+            if (!m_unigrams.has(tid)) {
+                continue;
+            }
+            // the "full" averages have only ever summed the stopwords
+            if (is_stopword(qry, i)) {
+                idf_full += idf(tid);
+                ictf_full += ictf(tid);
+                continue;
+            }
+            sum_cdf += m_unigrams.cdf(tid);
+            sum += idf(tid);
+            sum_sqrs += idf(tid) * idf(tid);
+            tf_min = std::min(tf_min, tf_min_c[tid]);
+            tf_max = std::max(tf_max, tf_max_c[tid]);
+            ictf_stopped += ictf(tid);
+        }
+
+        double avg = 0.0, variance = 0.0, std_dev = 0.0, confidence = 0.0;
+        double avidf = 0.0, avictf = 0.0;
+        if (len_stopped) {
+            avg        = sum / len_stopped;
+            variance   = sum_sqrs / len_stopped - avg * avg;
+            std_dev    = sqrt(variance);
+            confidence = zeta * (std_dev / sqrt(len_stopped));
+            avidf      = sum / len_stopped;
+            avictf     = ictf_stopped / len_stopped;
+        }
+
+        *out++ = len_stopped;
+        // The simplified clarity score has always been zero: it is only summed when every term
+        // is a stopword, and stopwords are skipped.
+        *out++ = 0.0;
+        *out++ = (double)sum_cdf / m_total_docs;
+        *out++ = avg;
+        *out++ = variance;
+        *out++ = std_dev;
+        *out++ = confidence;
+        *out++ = tf_max / tf_min;
+        *out++ = avidf;
+        *out++ = idf_full / len;
+        *out++ = avictf;
+        *out++ = ictf_full / len;
+        return out;
+    }
+
+   public:
+    /* Per-thread buffers reused across queries. */
+    struct scratch {
+        std::vector<size_t> rows;
+    };
+
+    static constexpr size_t unigram_features = 159;
+    static constexpr size_t bigram_features  = 147;
+
+    preret_engine(const std::string &unigram_file,
+                  const std::string &bigram_file,
+                  const Lexicon &    lexicon)
+        : m_stop(lexicon.size(), 0),
+          m_total_docs(lexicon.document_count()),
+          m_total_terms(lexicon.term_count()) {
+        for (size_t i = 0; fgen_krovetz_stopwords[i] != NULL; ++i) {
+            m_stopwords.insert(fgen_krovetz_stopwords[i]);
+            auto tid = lexicon.term(fgen_krovetz_stopwords[i]);
+            if (!lexicon.is_oov(tid)) {
+                m_stop[tid] = 1;
+            }
+        }
+
+        m_unigrams.resize(lexicon.size());
+        load_stats(unigram_file, 1, [&](const feature_t &f) -> bool {
+            auto tid = lexicon.term(f.term);
+            if (lexicon.is_oov(tid)) {
+                return true;
+            }
+            if (m_unigrams.has(tid)) {
+                return false;
+            }
+            m_unigrams.set(tid, f);
+            return true;
+        });
+
+        std::string a, b;
+        load_stats(bigram_file, 2, [&](const feature_t &f) -> bool {
+            std::istringstream iss(f.term);
+            iss >> a >> b;
+            auto tid_a = lexicon.term(a), tid_b = lexicon.term(b);
+            if (lexicon.is_oov(tid_a) || lexicon.is_oov(tid_b)) {
+                return true;
+            }
+            auto key = bigram_table::pack(tid_a, tid_b);
+            if (m_bigram_rows.find(key) != bigram_table::npos) {
+                return false;
+            }
+            return m_bigram_rows.insert(key, m_bigrams.push_back(f));
+        });
+    }
+
+    static constexpr size_t size() { return unigram_features + bigram_features; }
+
+    /* Writes the `size()` features of `qry` to `out`. Safe to call concurrently. */
+    void compute(const query_train &qry, double *out, scratch &s) const {
+        const auto &tids = qry.tids;
+        auto &      rows = s.rows;
+
+        rows.clear();
+        for (auto tid : tids) {
+            if (m_unigrams.has(tid)) {
+                rows.push_back(tid);
+            }
+        }
+        if (rows.empty()) {
+            std::cerr << "WARN: No terms for Query " << qry.id << " in collection." << std::endl;
+            std::fill_n(out, unigram_features, 0.0);
+        } else {
+            double *end = write_metrics(m_unigrams, true, rows, out);
+            write_query_features(qry, end);
+        }
+        out += unigram_features;
+
+        rows.clear();
+        for (size_t j = 0; j < tids.size(); ++j) {
+            for (size_t k = 0; k < tids.size(); ++k) {
+                if (j == k || tids[j] >= m_stop.size() || tids[k] >= m_stop.size()) {
+                    continue;
+                }
+                auto row = m_bigram_rows.find(bigram_table::pack(tids[j], tids[k]));
+                if (row != bigram_table::npos) {
+                    rows.push_back(row);
+                }
+            }
+        }
+        if (rows.empty()) {
+            std::cerr << "WARN: No bigrams for Query " << qry.id << " in collection."
+                      << std::endl;
+            std::fill_n(out, bigram_features, 0.0);
+        } else {
+            write_metrics(m_bigrams, false, rows, out);
+        }
+    }
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "term_feature.hpp"
+
+/**
+ * Term statistics in struct-of-arrays layout: one row per term or bigram, one column per
+ * statistic, in the order of `feature_stat_fields()`.
+ */
+class stats_table {
+    std::vector<uint64_t>            m_cf;
+    std::vector<uint64_t>            m_cdf;
+    std::vector<double>              m_geo_mean;
+    std::vector<std::vector<double>> m_stats;
+
+   public:
+    enum model : size_t { bm25, tfidf, lm, pr, be, dph, dfr };
+    enum stat : size_t {
+        median, first, third, max, min, avg, variance, std_dev, confidence, hmean
+    };
+
+    static constexpr size_t stats_per_model = 10;
+
+    stats_table() : m_stats(feature_stats) {}
+
+    size_t size() const { return m_cdf.size(); }
+
+    void resize(size_t rows) {
+        m_cf.resize(rows);
+        m_cdf.resize(rows);
+        m_geo_mean.resize(rows);
+        for (auto &&column : m_stats) {
+            column.resize(rows);
+        }
+    }
+
+    void set(size_t row, const feature_t &f) {
+        m_cf[row]       = f.cf;
+        m_cdf[row]      = f.cdf;
+        m_geo_mean[row] = f.geo_mean;
+        auto &fields    = feature_stat_fields();
+        for (size_t i = 0; i < feature_stats; ++i) {
+            m_stats[i][row] = f.*fields[i];
+        }
+    }
+
+    size_t push_back(const feature_t &f) {
+        size_t row = size();
+        resize(row + 1);
+        set(row, f);
+        return row;
+    }
+
+    /* Statistics are only generated for lists with at least 4 postings, so cdf 0 is a hole. */
+    bool has(size_t row) const { return row < size() && m_cdf[row] != 0; }
+
+    uint64_t cf(size_t row) const { return m_cf[row]; }
+    uint64_t cdf(size_t row) const { return m_cdf[row]; }
+    double   geo_mean(size_t row) const { return m_geo_mean[row]; }
+
+    const std::vector<double> &column(model m, stat s) const {
+        return m_stats[m * stats_per_model + s];
+    }
+};
+
+/**
+ * Open-addressing table from a bigram of term ids, packed into 64 bits, to its row in a
+ * `stats_table`. Linear probing over a power of two number of slots; key 0 marks an empty slot,
+ * which never collides with a real bigram because term id 0 is unused.
+ */
+class bigram_table {
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_rows;
+    size_t                m_items = 0;
+    size_t                m_shift = 64;
+
+    size_t slot(uint64_t key) const {
+        // Fibonacci hashing spreads the consecutive ids of the low half over the table
+        return (key * 0x9E3779B97F4A7C15ULL) >> m_shift;
+    }
+
+    void grow() {
+        std::vector<uint64_t> keys(std::max<size_t>(16, m_keys.size() * 2), 0);
+        std::vector<uint32_t> rows(keys.size());
+        keys.swap(m_keys);
+        rows.swap(m_rows);
+        m_shift = 64;
+        while ((size_t(1) << (64 - m_shift)) < m_keys.size()) {
+            --m_shift;
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] != 0) {
+                place(keys[i], rows[i]);
+            }
+        }
+    }
+
+    void place(uint64_t key, uint32_t row) {
+        size_t mask = m_keys.size() - 1;
+        size_t pos  = slot(key);
+        while (m_keys[pos] != 0 && m_keys[pos] != key) {
+            pos = (pos + 1) & mask;
+        }
+        m_keys[pos] = key;
+        m_rows[pos] = row;
+    }
+
+   public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    static uint64_t pack(uint64_t tid_a, uint64_t tid_b) { return (tid_a << 32) | tid_b; }
+
+    /* Returns false if the bigram is already present. */
+    bool insert(uint64_t key, uint32_t row) {
+        if (find(key) != npos) {
+            return false;
+        }
+        // keep the load factor under 1/2
+        if (2 * (m_items + 1) > m_keys.size()) {
+            grow();
+        }
+        place(key, row);
+        ++m_items;
+        return true;
+    }
+
+    uint32_t find(uint64_t key) const {
+        if (m_keys.empty()) {
+            return npos;
+        }
+        size_t mask = m_keys.size() - 1;
+        size_t pos  = slot(key);
+        while (m_keys[pos] != 0) {
+            if (m_keys[pos] == key) {
+                return m_rows[pos];
+            }
+            pos = (pos + 1) & mask;
+        }
+        return npos;
+    }
+};
@@ -1,12 +1,12 @@
 #pragma once
 
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-#include "indri/QueryEnvironment.hpp"
-
 #include "lexicon.hpp"
 struct query_train {
     // query id
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "impact_index.hpp"
+
+/**
+ * Score-at-a-time retrieval over an `ImpactIndex`: the segments of the query terms are read by
+ * decreasing impact times query frequency into a dense accumulator per document, so the postings
+ * that add the most come first. A query can stop after a budget of postings, which bounds its
+ * cost whatever the length of its lists and ranks by the partial scores.
+ */
+class saat_retriever {
+   public:
+    struct result {
+        uint32_t docid;
+        double   score;
+    };
+
+   private:
+    /* A segment to read and what each of its postings adds. */
+    struct segment_ref {
+        ImpactSegment *segment;
+        uint32_t       impact;
+    };
+
+    ImpactIndex &                           m_index;
+    std::unordered_map<std::string, size_t> m_lists;
+    std::vector<uint32_t>                   m_acc;
+    std::vector<uint32_t>                   m_touched;
+    std::vector<segment_ref>                m_segments;
+    // decoded documents of the segment being read, reused across segments and queries
+    std::vector<uint32_t>                   m_docs;
+    size_t                                  m_postings = 0;
+
+   public:
+    explicit saat_retriever(ImpactIndex &index) : m_index(index), m_acc(index.max_doc + 1, 0) {
+        for (size_t t = 0; t < m_index.lists.size(); ++t) {
+            m_lists.insert(std::make_pair(m_index.lists[t].term, t));
+        }
+    }
+
+    /* Postings read since the retriever was made. */
+    size_t postings() const { return m_postings; }
+
+    /*
+     * The `k` best documents for the query `terms`, best first and ties by document id, reading at
+     * most `budget` postings, all of them if 0. A repeated term counts once with its query
+     * frequency, terms without a list are skipped.
+     */
+    std::vector<result> search(const std::vector<std::string> &terms, size_t k, size_t budget) {
+        using term_list = std::pair<size_t, uint32_t>;
+        std::vector<term_list> lists;
+        for (auto &&term : terms) {
+            auto it = m_lists.find(term);
+            if (it == m_lists.end()) {
+                continue;
+            }
+            auto seen = std::find_if(
+                lists.begin(), lists.end(), [&](term_list &l) { return l.first == it->second; });
+            if (seen != lists.end()) {
+                ++seen->second;
+            } else {
+                lists.push_back(std::make_pair(it->second, 1));
+            }
+        }
+        m_segments.clear();
+        for (auto &&l : lists) {
+            for (auto &&seg : m_index.lists[l.first].segments) {
+                m_segments.push_back(segment_ref{&seg, seg.impact * l.second});
+            }
+        }
+        auto by_impact = [](const segment_ref &a, const segment_ref &b) {
+            return a.impact > b.impact;
+        };
+        std::stable_sort(m_segments.begin(), m_segments.end(), by_impact);
+
+        size_t read = 0;
+        for (auto &&ref : m_segments) {
+            if (budget && read == budget) {
+                break;
+            }
+            ref.segment->decode(m_docs);
+            size_t n = budget ? std::min(m_docs.size(), budget - read) : m_docs.size();
+            for (size_t i = 0; i < n; ++i) {
+                if (m_acc[m_docs[i]] == 0) {
+                    m_touched.push_back(m_docs[i]);
+                }
+                m_acc[m_docs[i]] += ref.impact;
+            }
+            read += n;
+        }
+        m_postings += read;
+
+        std::vector<result> results;
+        results.reserve(m_touched.size());
+        for (uint32_t d : m_touched) {
+            results.push_back(result{d, m_acc[d] * m_index.scale});
+            m_acc[d] = 0;
+        }
+        m_touched.clear();
+        auto better = [](const result &a, const result &b) {
+            return a.score > b.score || (a.score == b.score && a.docid < b.docid);
+        };
+        k = std::min(k, results.size());
+        std::partial_sort(results.begin(), results.begin() + k, results.end(), better);
+        results.resize(k);
+        return results;
+    }
+};
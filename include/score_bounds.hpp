@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "cereal/types/vector.hpp"
+
+#include "doc_lens.hpp"
+#include "inverted_index.hpp"
+#include "lexicon.hpp"
+
+/* Largest BM25 term frequency factor of a posting list and of each block of it. */
+struct TermBounds {
+    float                 max_score = 0;
+    // last document id and largest factor of each block
+    std::vector<uint32_t> block_last;
+    std::vector<float>    block_max;
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(max_score, block_last, block_max);
+    }
+};
+
+/**
+ * A posting list encoded block by block with the codec of `PostingList`, so a cursor decodes only
+ * the blocks it visits. The documents of a block are gaps from the last document of the previous
+ * one; block i has its documents in `data` from `offsets[2 i]` and its frequencies from
+ * `offsets[2 i + 1]`, up to the next offset.
+ */
+struct BlockPostings {
+    IntegerCODEC &codec = *CODECFactory::getFromName("simdfastpfor256");
+
+    uint32_t              size = 0;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> data;
+
+    size_t blocks(size_t block_size) const { return (size + block_size - 1) / block_size; }
+
+    void encode(std::vector<uint32_t> &docs, std::vector<uint32_t> &freqs, size_t block_size) {
+        size = docs.size();
+        offsets.clear();
+        data.clear();
+        std::vector<uint32_t> gaps;
+        std::vector<uint32_t> out(2 * block_size + 1024);
+        for (size_t start = 0; start < docs.size(); start += block_size) {
+            size_t n = std::min(docs.size(), start + block_size) - start;
+            gaps.assign(docs.begin() + start, docs.begin() + start + n);
+            Delta::deltaSIMD(gaps.data(), n);
+            gaps[0] -= start ? docs[start - 1] : 0;
+            append(gaps.data(), n, out);
+            append(&freqs[start], n, out);
+        }
+        offsets.push_back(data.size());
+    }
+
+    /* Decodes block `b` of `block_size` into `docs` and `freqs`, after document `base`. */
+    void decode(size_t b, size_t block_size, uint32_t base, std::vector<uint32_t> &docs,
+                std::vector<uint32_t> &freqs) const {
+        size_t n = std::min<size_t>(size - b * block_size, block_size);
+        docs.resize(n);
+        freqs.resize(n);
+        size_t recoveredsize = n;
+        codec.decodeArray(&data[offsets[2 * b]], offsets[2 * b + 1] - offsets[2 * b], docs.data(),
+                          recoveredsize);
+        docs[0] += base;
+        Delta::inverseDeltaSIMD(docs.data(), n);
+        recoveredsize = n;
+        codec.decodeArray(&data[offsets[2 * b + 1]], offsets[2 * b + 2] - offsets[2 * b + 1],
+                          freqs.data(), recoveredsize);
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(size, offsets, data);
+    }
+
+   private:
+    void append(const uint32_t *values, size_t n, std::vector<uint32_t> &out) {
+        size_t compressedsize = out.size();
+        codec.encodeArray(values, n, out.data(), compressedsize);
+        offsets.push_back(data.size());
+        data.insert(data.end(), out.begin(), out.begin() + compressedsize);
+    }
+};
+
+/* BM25 of the `bm25_atire` column with its own (k1, b), over the statistics of a lexicon. */
+struct BM25Params {
+    double k1          = 0.9;
+    double b           = 0.4;
+    double num_docs    = 0;
+    double avg_doc_len = 0;
+
+    void set_collection(const Lexicon &lexicon) {
+        num_docs    = lexicon.document_count();
+        avg_doc_len = (double)lexicon.term_count() / lexicon.document_count();
+    }
+
+    double norm(double len) const { return k1 * ((1 - b) + (b * (len / avg_doc_len))); }
+    double factor(double tf, double norm) const { return ((k1 + 1) * tf) / (norm + tf); }
+
+    /* Weight of a term in `f_t` documents, the score of a posting is its factor times this. */
+    double weight(double f_qt, double f_t) const {
+        return std::max(1e-6, std::log((num_docs - f_t + 0.5) / (f_t + 0.5)) * f_qt);
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(k1, b, num_docs, avg_doc_len);
+    }
+};
+
+/**
+ * BM25 upper bounds of the posting lists of an `InvertedIndex`, in list order, for one (k1, b),
+ * and the lists again as `BlockPostings` of the same blocks for the retriever to decode lazily.
+ * A bound is taken over the term frequency factor (k1 + 1) tf / (norm + tf) of the postings, so
+ * the bound of a query term is the stored one times the term weight.
+ *
+ * Bounds are rounded to the next float strictly above, a margin far wider than the rounding error
+ * of summing a few double scores in a different order.
+ */
+struct ScoreBounds {
+    BM25Params                 bm25;
+    uint32_t                   block_size = 64;
+    std::vector<TermBounds>    terms;
+    std::vector<BlockPostings> lists;
+
+    static float round_up(double v) {
+        float f = static_cast<float>(v);
+        return f > v ? f : std::nextafter(f, std::numeric_limits<float>::infinity());
+    }
+
+    /* Bounds of every list of `inv_idx`, with the collection statistics of `lexicon`. */
+    void build(InvertedIndex &inv_idx, const DocLens &doc_lens, const Lexicon &lexicon) {
+        bm25.set_collection(lexicon);
+        terms.assign(inv_idx.size(), TermBounds());
+        lists.clear();
+        lists.resize(inv_idx.size());
+        for (size_t t = 0; t < inv_idx.size(); ++t) {
+            auto   list     = inv_idx[t].list();
+            auto & docs     = list.first;
+            auto & freqs    = list.second;
+            auto & bounds   = terms[t];
+            double term_max = 0;
+            for (size_t start = 0; start < docs.size(); start += block_size) {
+                size_t end       = std::min(docs.size(), start + block_size);
+                double block_max = 0;
+                for (size_t i = start; i < end; ++i) {
+                    double f  = bm25.factor(freqs[i], bm25.norm(doc_lens[docs[i]]));
+                    block_max = std::max(block_max, f);
+                }
+                bounds.block_last.push_back(docs[end - 1]);
+                bounds.block_max.push_back(round_up(block_max));
+                term_max = std::max(term_max, block_max);
+            }
+            bounds.max_score = round_up(term_max);
+            lists[t].encode(docs, freqs, block_size);
+        }
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(bm25, block_size, terms, lists);
+    }
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "cereal/types/vector.hpp"
+
+#include "doc_entry.hpp"
+#include "lexicon.hpp"
+
+#include "features/features.hpp"
+
+/* `doc_entry` members read from the forward index. */
+#define STATIC_INDEX_FEATURES(X) X(length) X(pagerank) X(url_slash_count) X(url_length)
+
+/* Columns of the stream extractor which do not depend on the query. */
+#define STATIC_STREAM_FEATURES(X)                                                                  \
+    X(stream_len)                                                                                  \
+    X(stream_len_body)                                                                             \
+    X(stream_len_title)                                                                            \
+    X(stream_len_heading)                                                                          \
+    X(stream_len_inlink)                                                                           \
+    X(stream_len_a)
+
+/* Columns of the tags extractor which do not depend on the query. */
+#define STATIC_TAG_FEATURES(X)                                                                     \
+    X(tag_title_count)                                                                             \
+    X(tag_heading_count)                                                                           \
+    X(tag_inlink_count)                                                                            \
+    X(tag_applet_count)                                                                            \
+    X(tag_object_count)                                                                            \
+    X(tag_embed_count)
+
+#define STATIC_COUNT(name) +1
+
+/**
+ * Query-independent features of every document of a forward index, a dense row per docid: the
+ * `STATIC_*_FEATURES` members of its `doc_entry` in that order, then the length normalisation K_d
+ * of each `doc_entry` BM25 model for the whole document and each scored field, in
+ * `batch_scorer::column` order. Extraction copies these from the row rather than computing them
+ * from the `Document` for every query.
+ *
+ * A table is only valid for the forward index, lexicon and field ids it was built with.
+ */
+struct StaticFeatures {
+    static constexpr size_t index_columns  = 0 STATIC_INDEX_FEATURES(STATIC_COUNT);
+    static constexpr size_t stream_columns = 0 STATIC_STREAM_FEATURES(STATIC_COUNT);
+    static constexpr size_t tag_columns    = 0 STATIC_TAG_FEATURES(STATIC_COUNT);
+    static constexpr size_t norm_columns   = batch_scorer::norm_models * batch_scorer::scope_count;
+    static constexpr size_t columns = index_columns + stream_columns + tag_columns + norm_columns;
+
+    uint64_t            num_docs   = 0;
+    uint64_t            term_count = 0;
+    std::vector<int>    field_ids;
+    std::vector<double> values;
+
+    size_t rows() const { return values.size() / columns; }
+
+    const double *norms(size_t docid) const {
+        return &values[docid * columns + index_columns + stream_columns + tag_columns];
+    }
+
+    /* Starts a table for the collection of `lexicon` and the field ids of `view`. */
+    void set_collection(const Lexicon &lexicon, const query_doc_view &view, size_t docs) {
+        num_docs   = lexicon.document_count();
+        term_count = lexicon.term_count();
+        field_ids.clear();
+        for (size_t f = 0; f < query_doc_view::field_count; ++f) {
+            field_ids.push_back(view.field_at(f).id);
+        }
+        values.clear();
+        values.reserve(docs * columns);
+    }
+
+    /*
+     * Appends the row of the next docid from its `doc_entry`, with the static columns computed, and
+     * its view. The normalisations are those of `scorer`, which must score every BM25 model.
+     */
+    void add(const doc_entry &doc, const query_doc_view &view, const batch_scorer &scorer) {
+#define STATIC_ADD(name) values.push_back(doc.name);
+        STATIC_INDEX_FEATURES(STATIC_ADD)
+        STATIC_STREAM_FEATURES(STATIC_ADD)
+        STATIC_TAG_FEATURES(STATIC_ADD)
+#undef STATIC_ADD
+        for (size_t m = 0; m < batch_scorer::norm_models; ++m) {
+            for (size_t s = 0; s < batch_scorer::scope_count; ++s) {
+                double len = s == 0 ? view.length() : view.field_at(s - 1).len;
+                values.push_back(scorer.norm(m, len));
+            }
+        }
+    }
+
+    /* Copies the static columns of `docid`, those of the stream and tags extractors if asked. */
+    void copy(size_t docid, doc_entry &doc, bool stream, bool tags) const {
+        const double *row = &values[docid * columns];
+#define STATIC_COPY(name) doc.name = static_cast<decltype(doc.name)>(*row++);
+        STATIC_INDEX_FEATURES(STATIC_COPY)
+        if (stream) {
+            STATIC_STREAM_FEATURES(STATIC_COPY)
+        } else {
+            row += stream_columns;
+        }
+        if (tags) {
+            STATIC_TAG_FEATURES(STATIC_COPY)
+        }
+#undef STATIC_COPY
+    }
+
+    /* Exits unless the table has `docs` rows and was built with `lexicon` and the view's fields. */
+    void check(size_t docs, const Lexicon &lexicon, const query_doc_view &view) const {
+        bool same = rows() == docs && num_docs == lexicon.document_count() &&
+                    term_count == lexicon.term_count() &&
+                    field_ids.size() == query_doc_view::field_count;
+        for (size_t f = 0; same && f < field_ids.size(); ++f) {
+            same = field_ids[f] == view.field_at(f).id;
+        }
+        if (!same) {
+            std::cerr << "Static features built for another index" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    template <class Archive>
+    void serialize(Archive &archive) {
+        archive(num_docs, term_count, field_ids, values);
+    }
+};
+
+#undef STATIC_COUNT
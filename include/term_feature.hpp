@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string.h>
+#include <array>
+#include <cctype>
+#include <cstdlib>
 #include <numeric>
 #include <cmath>
 #include <cstdio>
@@ -175,6 +178,84 @@ std::ostream &operator<<(std::ostream &os, const feature_t &f) {
     return os;
 }
 
+/* The statistics following the term, cf, cdf and geo_mean, in the order operator<< writes them. */
+constexpr size_t feature_stats = 70;
+
+const std::array<double feature_t::*, feature_stats> &feature_stat_fields() {
+    static const std::array<double feature_t::*, feature_stats> fields = {{
+        &feature_t::bm25_median, &feature_t::bm25_first, &feature_t::bm25_third,
+        &feature_t::bm25_max, &feature_t::bm25_min, &feature_t::bm25_avg,
+        &feature_t::bm25_variance, &feature_t::bm25_std_dev, &feature_t::bm25_confidence,
+        &feature_t::bm25_hmean, &feature_t::tfidf_median, &feature_t::tfidf_first,
+        &feature_t::tfidf_third, &feature_t::tfidf_max, &feature_t::tfidf_min,
+        &feature_t::tfidf_avg, &feature_t::tfidf_variance, &feature_t::tfidf_std_dev,
+        &feature_t::tfidf_confidence, &feature_t::tfidf_hmean, &feature_t::lm_median,
+        &feature_t::lm_first, &feature_t::lm_third, &feature_t::lm_max, &feature_t::lm_min,
+        &feature_t::lm_avg, &feature_t::lm_variance, &feature_t::lm_std_dev,
+        &feature_t::lm_confidence, &feature_t::lm_hmean, &feature_t::pr_median,
+        &feature_t::pr_first, &feature_t::pr_third, &feature_t::pr_max, &feature_t::pr_min,
+        &feature_t::pr_avg, &feature_t::pr_variance, &feature_t::pr_std_dev,
+        &feature_t::pr_confidence, &feature_t::pr_hmean, &feature_t::be_median,
+        &feature_t::be_first, &feature_t::be_third, &feature_t::be_max, &feature_t::be_min,
+        &feature_t::be_avg, &feature_t::be_variance, &feature_t::be_std_dev,
+        &feature_t::be_confidence, &feature_t::be_hmean, &feature_t::dph_median,
+        &feature_t::dph_first, &feature_t::dph_third, &feature_t::dph_max, &feature_t::dph_min,
+        &feature_t::dph_avg, &feature_t::dph_variance, &feature_t::dph_std_dev,
+        &feature_t::dph_confidence, &feature_t::dph_hmean, &feature_t::dfr_median,
+        &feature_t::dfr_first, &feature_t::dfr_third, &feature_t::dfr_max, &feature_t::dfr_min,
+        &feature_t::dfr_avg, &feature_t::dfr_variance, &feature_t::dfr_std_dev,
+        &feature_t::dfr_confidence, &feature_t::dfr_hmean}};
+    return fields;
+}
+
+/* Parses a line written by operator<<, the first `arity` tokens form the term. */
+bool parse_feature(const std::string &line, size_t arity, feature_t &f) {
+    const char *p   = line.c_str();
+    char *      end = nullptr;
+    f.term.clear();
+    for (size_t i = 0; i < arity; ++i) {
+        while (isspace(*p)) {
+            ++p;
+        }
+        const char *start = p;
+        while (*p && !isspace(*p)) {
+            ++p;
+        }
+        if (start == p) {
+            return false;
+        }
+        f.term.append(start, p);
+        f.term.push_back(' ');
+    }
+    // unigrams carry no trailing space, bigrams keep the one of the bigram index
+    if (arity == 1) {
+        f.term.pop_back();
+    }
+
+    f.cf = strtoull(p, &end, 10);
+    if (end == p) {
+        return false;
+    }
+    p     = end;
+    f.cdf = strtoull(p, &end, 10);
+    if (end == p) {
+        return false;
+    }
+    p          = end;
+    f.geo_mean = strtod(p, &end);
+    if (end == p) {
+        return false;
+    }
+    for (auto field : feature_stat_fields()) {
+        p        = end;
+        f.*field = strtod(p, &end);
+        if (end == p) {
+            return false;
+        }
+    }
+    return true;
+}
+
 double compute_geo_mean(const std::vector<uint32_t> &freqs) {
     double sum = 0.0;
     for (auto &&f : freqs) {
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads running index ranges. A pool of one thread runs everything on the
+ * calling thread.
+ *
+ * Each worker starts on an equal slice of the indices and, once its slice is done, steals the
+ * back half of another worker's remaining slice, so uneven tasks still keep every thread busy.
+ */
+class thread_pool {
+    using task_type = std::function<void(size_t, size_t)>;
+
+    /*
+     * Unclaimed indices [begin, end) of one worker packed in a single word: the owner takes from
+     * the front and thieves split off the back with compare-and-swap, never with a lock. An index
+     * is handed out once, so a word never returns to a value a stalled thief may still hold.
+     */
+    struct slice {
+        std::atomic<uint64_t> bounds;
+        char                  pad[64 - sizeof(std::atomic<uint64_t>)];
+
+        slice() : bounds(0) {}
+    };
+
+    static uint64_t pack(uint64_t begin, uint64_t end) { return (begin << 32) | end; }
+    static uint64_t begin_of(uint64_t bounds) { return bounds >> 32; }
+    static uint64_t end_of(uint64_t bounds) { return bounds & 0xFFFFFFFFULL; }
+
+    std::vector<std::thread> m_threads;
+    std::vector<slice>       m_slices;
+    std::mutex               m_mutex;
+    std::condition_variable  m_start;
+    std::condition_variable  m_done;
+    task_type                m_task;
+    size_t                   m_generation = 0;
+    size_t                   m_active     = 0;
+    bool                     m_stop       = false;
+
+    bool pop(size_t thread, size_t &index) {
+        auto &   bounds = m_slices[thread].bounds;
+        uint64_t cur    = bounds.load();
+        while (begin_of(cur) < end_of(cur)) {
+            if (bounds.compare_exchange_weak(cur, pack(begin_of(cur) + 1, end_of(cur)))) {
+                index = begin_of(cur);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool steal(size_t thread) {
+        for (size_t k = 1; k < m_slices.size(); ++k) {
+            auto &   victim = m_slices[(thread + k) % m_slices.size()].bounds;
+            uint64_t cur    = victim.load();
+            while (begin_of(cur) < end_of(cur)) {
+                uint64_t mid = begin_of(cur) + (end_of(cur) - begin_of(cur)) / 2;
+                if (victim.compare_exchange_weak(cur, pack(begin_of(cur), mid))) {
+                    m_slices[thread].bounds.store(pack(mid, end_of(cur)));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void work(size_t thread) {
+        size_t generation = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&] { return m_stop || m_generation != generation; });
+            if (m_stop) {
+                return;
+            }
+            generation = m_generation;
+            auto task  = m_task;
+            lock.unlock();
+
+            size_t i;
+            do {
+                while (pop(thread, i)) {
+                    task(i, thread);
+                }
+            } while (steal(thread));
+
+            lock.lock();
+            if (--m_active == 0) {
+                m_done.notify_all();
+            }
+        }
+    }
+
+   public:
+    explicit thread_pool(size_t threads) {
+        if (threads > 1) {
+            m_slices = std::vector<slice>(threads);
+        }
+        for (size_t t = 0; threads > 1 && t < threads; ++t) {
+            m_threads.emplace_back(&thread_pool::work, this, t);
+        }
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (auto &&t : m_threads) {
+            t.join();
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    size_t size() const { return std::max<size_t>(1, m_threads.size()); }
+
+    /* Calls `task(i, thread)` for every i in [0, n), n < 2^32, with thread in [0, size()). */
+    void parallel_for(size_t n, const task_type &task) {
+        if (m_threads.empty()) {
+            for (size_t i = 0; i < n; ++i) {
+                task(i, 0);
+            }
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task = task;
+        for (size_t t = 0; t < m_slices.size(); ++t) {
+            m_slices[t].bounds.store(
+                pack(n * t / m_slices.size(), n * (t + 1) / m_slices.size()));
+        }
+        m_active = m_threads.size();
+        ++m_generation;
+        m_start.notify_all();
+        m_done.wait(lock, [&] { return m_active == 0; });
+    }
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
@@ -86,6 +87,17 @@ class trec_run_file {
         scores.emplace(last_id, score_list);
     }
 
+    /* Length of the longest docno of all topics. */
+    size_t max_docno_length() const {
+        size_t len = 0;
+        for (auto &&r : results) {
+            for (auto &&docno : r.second) {
+                len = std::max(len, docno.size());
+            }
+        }
+        return len;
+    }
+
     std::vector<std::string> get_result(int id) {
         auto it = results.find(id);
 
@@ -13,6 +13,7 @@ from sklearn.preprocessing import MaxAbsScaler
 import core
 from core.cascade import load_data_file, load_data, load_costs_data, load_model, save_model
 from core.cascade import Prune, TreeModel, SVMModel, SGDClassifierModel, group_offsets
+from core.cascade import get_feature_mask, get_feature_names, export_cascade
 from core.metrics import test_all
 
 
@@ -572,6 +573,23 @@ def do_info(model_file):
     print('total n_features', len(s))
 
 
+@baker.command(name='feature_names')
+def do_feature_names(model_file, feature_names_file, stages=None):
+    """Print the names of the features used by the first `stages` stages, one per line, as read
+    by `generate_document_features --features`."""
+    cascade = load_model(model_file)
+    mask = get_feature_mask(cascade, int(stages) if stages else None)
+    for name in get_feature_names(mask, feature_names_file):
+        print(name)
+
+
+@baker.command(name='export')
+def do_export(model_file, n_features, output_file):
+    """Export a saved cascade as text for `cascade_rank`"""
+    cascade = load_model(model_file)
+    export_cascade(cascade, int(n_features), output_file)
+
+
 if __name__ == "__main__":
     logging.basicConfig(
         format='%(asctime)s : %(levelname)s : %(message)s', level=logging.INFO)
@@ -1,8 +1,10 @@
 from __future__ import print_function
 
+import json
 import logging
 import math
 import numpy as np
+import re
 
 from sklearn.datasets import load_svmlight_file
 from sklearn.externals import joblib
@@ -132,6 +134,98 @@ def partial_predict(stage, state, x, qid, score_update):
     return {'preds': preds, 'indexes': indexes, 'extract_counts': extract_counts}
 
 
+def get_feature_mask(cascade, stages=None):
+    """Union of the feature masks of the first `stages` stages, of all stages by default."""
+    mask = None
+    for _, model in cascade['stages'][:stages]:
+        stage_mask = model.get_feature_mask()
+        mask = stage_mask if mask is None else np.maximum(mask, stage_mask)
+    return mask
+
+
+def get_feature_names(mask, feature_names_file):
+    """Names of the features in `mask`, column i being feature id i + 1 in `feature-names.txt`."""
+    names = {}
+    for line in open(feature_names_file):
+        fields = line.split()
+        if fields:
+            names[int(fields[0])] = fields[-1]
+    return [names[i] for i in np.flatnonzero(mask) + 1]
+
+
+def export_cascade(cascade, n_features, filename):
+    """Write the cascade as text for `cascade_rank`: the score update, the scaler and, per stage,
+    the prune rule and the linear weights or the xgboost trees. Feature i is column i of x."""
+    def write_prune(out, prune):
+        if prune is not None and prune.rank:
+            out.write('prune rank %d\n' % prune.rank)
+        elif prune is not None and prune.beta:
+            out.write('prune beta %r\n' % prune.beta)
+        else:
+            out.write('prune none\n')
+
+    def write_linear(out, coef, intercept):
+        fids = np.flatnonzero(coef)
+        out.write('linear %d %r\n' % (fids.size, float(intercept)))
+        for i in fids:
+            out.write('%d %r\n' % (i, float(coef[i])))
+
+    def base_score(booster):
+        # predict adds the global bias to the margin, get_dump leaves it out
+        try:
+            config = json.loads(booster.save_config())
+        except AttributeError:
+            return 0.5  # the default of the xgboost versions without save_config
+        return float(config['learner']['learner_model_param']['base_score'].strip('[]'))
+
+    def write_trees(out, model):
+        from . import get_score_multiclass
+
+        n_classes = 1
+        if model.score_function is get_score_multiclass:
+            n_classes = len(model.class_weights)
+        dump = model.model.get_dump()
+        out.write('trees %d %d %r\n' % (n_classes, len(dump), base_score(model.model)))
+        if n_classes > 1:
+            out.write('class_weights %s\n' % ' '.join('%r' % float(w) for w in model.class_weights))
+        for tree in dump:
+            nodes = [line.strip() for line in tree.split('\n') if line.strip()]
+            out.write('tree %d\n' % len(nodes))
+            for node in nodes:
+                m = re.match(r'(\d+):leaf=(\S+)', node)
+                if m:
+                    out.write('%s leaf %s\n' % m.groups())
+                    continue
+                m = re.match(r'(\d+):\[f(\d+)<(\S+)\] yes=(\d+),no=(\d+)', node)
+                if not m:
+                    raise ValueError('Unexpected tree node: %s' % node)
+                out.write('%s %s %s %s %s\n' % m.groups())
+
+    with open(filename, 'w') as out:
+        out.write('cascade %d %d\n' % (len(cascade['stages']), n_features))
+        update = cascade['score_update']
+        if isinstance(update, ResetUpdate):
+            out.write('update reset %r\n' % update.gap)
+        elif isinstance(update, UpshiftUpdate):
+            out.write('update upshift %r\n' % update.gap)
+        else:
+            out.write('update additive\n')
+        if 'scaler' in cascade:
+            scale = cascade['scaler'].scale_
+            out.write('scale %d %s\n' % (scale.size, ' '.join('%r' % float(v) for v in scale)))
+        for prune, model in cascade['stages']:
+            out.write('stage\n')
+            write_prune(out, prune)
+            if isinstance(model, LinearModel):
+                write_linear(out, model.coef, 0)
+            elif isinstance(model, SGDClassifierModel):
+                write_linear(out, model.model.coef_[0], model.model.intercept_[0])
+            elif isinstance(model, TreeModel):
+                write_trees(out, model)
+            else:
+                raise ValueError('Cannot export a %s stage' % type(model).__name__)
+
+
 def print_trec_run(output, preds, y, qid, docno=None, run_id='exp'):
     for a, b in group_offsets(qid):
         sim = preds[a:b].copy()
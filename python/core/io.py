@@ -56,6 +56,19 @@ def load_npz(filename):
     return x, y, qid, docno
 
 
+def load_features_npy(filename):
+    """Map the binary output of generate_document_features (--format float32/float64).
+
+    Returns the feature matrix as a read-only view of the file, with the labels, qids, docnos
+    and feature names."""
+    data = np.load(filename, mmap_mode='r')
+    names = [name for name in data.dtype.names if name not in ('label', 'qid', 'docno')]
+    dtype, offset = data.dtype.fields[names[0]][:2]
+    x = np.ndarray((data.shape[0], len(names)), dtype=dtype, buffer=data, offset=offset,
+                   strides=(data.dtype.itemsize, dtype.itemsize))
+    return x, data['label'], data['qid'], data['docno'], names
+
+
 def load_scores(filename):
     """Load scores from text file"""
     return np.loadtxt(filename)
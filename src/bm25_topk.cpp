@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "cereal/archives/binary.hpp"
+
+#include "bm25_retriever.hpp"
+#include "doc_lens.hpp"
+#include "docno_map.hpp"
+#include "inverted_index.hpp"
+#include "lexicon.hpp"
+#include "query_train_file.hpp"
+#include "score_bounds.hpp"
+
+int main(int argc, char **argv) {
+    std::string query_file;
+    std::string inverted_index_file;
+    std::string doc_lens_file;
+    std::string lexicon_file;
+    std::string score_bounds_file;
+    std::string docno_map_file;
+    std::string output_file;
+    std::string algorithm = "bmw";
+    std::string run_id    = "bm25";
+    size_t      depth     = 1000;
+
+    CLI::App app{"Stage 0 BM25 run of the top documents of each query, without Indri."};
+    app.add_option("query_file", query_file, "Query file")->required();
+    app.add_option("inverted_index_file", inverted_index_file, "Inverted index file")->required();
+    app.add_option("doc_lens_file", doc_lens_file, "Document lens file")->required();
+    app.add_option("lexicon_file", lexicon_file, "Lexicon file")->required();
+    app.add_option("score_bounds_file", score_bounds_file, "Score bounds from create_score_bounds")
+        ->required();
+    app.add_option("docno_map_file", docno_map_file, "Docno map from create_forward_index")
+        ->required();
+    app.add_option("output_file", output_file, "Output TREC run file")->required();
+    app.add_option("-k,--depth", depth, "Documents per query", true);
+    app.add_option("-a,--algorithm", algorithm, "bmw, maxscore or exhaustive", true);
+    app.add_option("--run-id", run_id, "Run id of the output", true);
+    CLI11_PARSE(app, argc, argv);
+
+    bm25_retriever::algorithm algo = bm25_retriever::block_max_wand;
+    if (algorithm == "maxscore") {
+        algo = bm25_retriever::maxscore;
+    } else if (algorithm == "exhaustive") {
+        algo = bm25_retriever::exhaustive;
+    } else if (algorithm != "bmw") {
+        std::cerr << "Unknown algorithm: " << algorithm << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    using clock = std::chrono::high_resolution_clock;
+    auto start  = clock::now();
+
+    InvertedIndex inv_idx;
+    DocLens       doc_lens;
+    Lexicon       lexicon;
+    ScoreBounds   bounds;
+    {
+        std::ifstream              ifs_inv(inverted_index_file);
+        cereal::BinaryInputArchive iarchive_inv(ifs_inv);
+        iarchive_inv(inv_idx);
+    }
+    {
+        std::ifstream              ifs_len(doc_lens_file);
+        cereal::BinaryInputArchive iarchive_len(ifs_len);
+        iarchive_len(doc_lens);
+    }
+    {
+        std::ifstream              ifs_lex(lexicon_file);
+        cereal::BinaryInputArchive iarchive_lex(ifs_lex);
+        iarchive_lex(lexicon);
+    }
+    {
+        std::ifstream              ifs_bounds(score_bounds_file);
+        cereal::BinaryInputArchive iarchive_bounds(ifs_bounds);
+        iarchive_bounds(bounds);
+    }
+    docno_map docnos(docno_map_file);
+
+    auto stop      = clock::now();
+    auto load_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    std::cerr << "Loaded the index in " << load_time.count() << " ms" << std::endl;
+
+    std::ifstream ifs(query_file);
+    if (!ifs.is_open()) {
+        std::cerr << "Could not open file: " << query_file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    query_train_file qtfile(ifs, lexicon);
+
+    std::ofstream outfile(output_file);
+    if (!outfile.is_open()) {
+        std::cerr << "Could not open file: " << output_file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    bm25_retriever                      retriever(inv_idx, doc_lens, bounds);
+    clock::duration                     time{0};
+    std::vector<bm25_retriever::result> results;
+    char                                buf[64];
+    for (auto &&qry : qtfile.get_queries()) {
+        start   = clock::now();
+        results = retriever.search(qry.stems, depth, algo);
+        time += clock::now() - start;
+        for (size_t r = 0; r < results.size(); ++r) {
+            snprintf(buf, sizeof(buf), " %zu %f ", r + 1, results[r].score);
+            outfile << qry.id << " Q0 " << docnos.docno(results[r].docid) << buf << run_id << "\n";
+        }
+    }
+
+    auto queries = qtfile.get_queries().size();
+    auto ms      = std::chrono::duration_cast<std::chrono::microseconds>(time).count() / 1000.0;
+    std::cerr << queries << " queries in " << ms << " ms, " << retriever.scored()
+              << " documents scored" << std::endl;
+    return 0;
+}
@@ -0,0 +1,348 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "cereal/archives/binary.hpp"
+
+#include "cascade_model.hpp"
+#include "doc_entry.hpp"
+#include "docno_resolver.hpp"
+#include "feature_pipeline.hpp"
+#include "field_id.hpp"
+#include "forward_index.hpp"
+#include "lexicon.hpp"
+#include "query_train_file.hpp"
+#include "thread_pool.hpp"
+#include "trec_run_file.hpp"
+
+namespace {
+/* Features first read by a stage, split into document and query features. */
+struct stage_plan {
+    std::vector<size_t> doc_features;
+    std::vector<size_t> query_features;
+    std::vector<bool>   doc_mask;
+    pipeline            extract;
+};
+
+/* Work done by a stage, summed over the queries. */
+struct stage_stats {
+    size_t                                       docs   = 0;
+    size_t                                       values = 0;
+    std::chrono::high_resolution_clock::duration time{0};
+};
+
+/* The TREC run of one query, resolved to Indri document ids, and its ranking. */
+struct query_run {
+    query_train *            qry;
+    std::vector<double>      stage0_scores;
+    std::vector<std::string> docnos;
+    std::vector<docid_t>     docids;
+    std::vector<stage_stats> stats;
+    std::string              rows;
+};
+
+/* Pre-retrieval features of `preret_csv`, one row per query, nan read as 0 as in training. */
+std::map<int, std::vector<double>> read_query_features(const std::string &file) {
+    std::ifstream ifs(file);
+    if (!ifs.is_open()) {
+        std::cerr << "Could not open file: " << file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::map<int, std::vector<double>> features;
+    std::string                        line, value;
+    while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        if (!std::getline(iss, value, ',')) {
+            continue;
+        }
+        auto &row = features[std::stoi(value)];
+        while (std::getline(iss, value, ',')) {
+            double v = std::stod(value);
+            row.push_back(std::isnan(v) ? 0.0 : v);
+        }
+    }
+    return features;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+
+    std::string query_file;
+    std::string trec_file;
+    std::string repo_path;
+    std::string forward_index_file;
+    std::string lexicon_file;
+    std::string model_file;
+    std::string output_file;
+    std::string query_features_file;
+    std::string docno_map_file;
+    std::string fields_file;
+    std::string static_features_file;
+    std::string run_id  = "cascade";
+    size_t      threads = 1;
+
+    CLI::App app{"Rank a TREC run with a cascade, extracting features for the survivors only."};
+    app.add_option("query_file", query_file, "Query file")->required();
+    app.add_option("trec_file", trec_file, "TREC run file")->required();
+    app.add_option("repo_path", repo_path, "Indri repo path, unused with --docno-map and --fields")
+        ->required();
+    app.add_option("forward_index_file", forward_index_file, "Forward index file")->required();
+    app.add_option("lexicon_file", lexicon_file, "Lexicon file")->required();
+    app.add_option("model_file", model_file, "Cascade from `Cascade.py export`")->required();
+    app.add_option("output_file", output_file, "Output TREC run file")->required();
+    app.add_option("--query-features", query_features_file, "Query features from preret_csv");
+    app.add_option("--run-id", run_id, "Run id of the output", true);
+    app.add_option("-j,--threads", threads, "Number of threads", true);
+    app.add_option("--docno-map", docno_map_file, "Docno map from create_forward_index");
+    app.add_option("--fields", fields_file, "Field ids from create_forward_index");
+    app.add_option("--static-features",
+                   static_features_file,
+                   "Static features from create_static_features, copied rather than computed");
+    CLI11_PARSE(app, argc, argv);
+
+    cascade_model model(model_file);
+
+    // a stage extracts only the features no earlier stage has read
+    const auto &            doc_names = doc_entry::names();
+    std::vector<stage_plan> plans(model.stages().size());
+    std::vector<bool>       seen(model.features(), false);
+    for (size_t s = 0; s < plans.size(); ++s) {
+        auto &                   plan = plans[s];
+        std::vector<std::string> names;
+        plan.doc_mask.assign(doc_names.size(), false);
+        for (size_t f : model.stages()[s].features) {
+            if (seen[f]) {
+                continue;
+            }
+            seen[f] = true;
+            if (f < doc_names.size()) {
+                plan.doc_features.push_back(f);
+                plan.doc_mask[f] = true;
+                names.push_back(doc_names[f]);
+            } else {
+                plan.query_features.push_back(f);
+            }
+        }
+        plan.extract = select_pipeline(names);
+    }
+
+    bool reads_query_features = false;
+    for (auto &&plan : plans) {
+        reads_query_features = reads_query_features || !plan.query_features.empty();
+    }
+    std::map<int, std::vector<double>> query_features;
+    if (!query_features_file.empty()) {
+        query_features = read_query_features(query_features_file);
+    } else if (reads_query_features) {
+        std::cerr << "No --query-features, the query features of the model are 0" << std::endl;
+    }
+
+    docno_resolver resolver(repo_path, docno_map_file, fields_file);
+
+    using clock = std::chrono::high_resolution_clock;
+    auto start  = clock::now();
+
+    // load fwd_idx
+    std::ifstream              ifs_fwd(forward_index_file);
+    cereal::BinaryInputArchive iarchive_fwd(ifs_fwd);
+    ForwardIndex               fwd_idx;
+    iarchive_fwd(fwd_idx);
+
+    auto stop      = clock::now();
+    auto load_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    std::cerr << "Loaded " << forward_index_file << " in " << load_time.count() << " ms"
+              << std::endl;
+
+    // load lexicon
+    std::ifstream              lexicon_f(lexicon_file);
+    cereal::BinaryInputArchive iarchive_lex(lexicon_f);
+    Lexicon                    lexicon;
+    iarchive_lex(lexicon);
+
+    StaticFeatures statics;
+    if (!static_features_file.empty()) {
+        std::ifstream              ifs_static(static_features_file);
+        cereal::BinaryInputArchive iarchive_static(ifs_static);
+        iarchive_static(statics);
+    }
+
+    // load query file
+    std::ifstream ifs(query_file);
+    if (!ifs.is_open()) {
+        std::cerr << "Could not open file: " << query_file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    query_train_file qtfile(ifs, lexicon);
+    ifs.close();
+    ifs.clear();
+
+    // load trec run file
+    ifs.open(trec_file);
+    trec_run_file trec_run(ifs);
+    trec_run.parse();
+    ifs.close();
+    ifs.clear();
+
+    FieldIdMap                     field_id_map;
+    const std::vector<std::string> idx_fields = {
+        "title", "heading", "mainbody", "inlink", "applet", "object", "embed"};
+    for (const std::string &field_str : idx_fields) {
+        int field_id = resolver.field(field_str);
+        if (field_id < 1) {
+            std::cerr << "field '" << field_str << "' does not exist" << std::endl;
+        }
+        field_id_map.insert(std::make_pair(field_str, field_id));
+    }
+
+    // one extractor set per stage and thread, each running the extractors of its stage only
+    thread_pool                             pool(threads);
+    std::vector<std::vector<extractor_set>> extractors;
+    for (auto &&plan : plans) {
+        extractors.emplace_back(pool.size(),
+                                extractor_set(lexicon, field_id_map, {}, {}, plan.extract));
+    }
+    if (!static_features_file.empty()) {
+        statics.check(fwd_idx.size(), lexicon, query_doc_view(field_id_map));
+        for (auto &&stage : extractors) {
+            for (auto &&ex : stage) {
+                ex.statics = &statics;
+            }
+        }
+    }
+    std::vector<std::vector<const Document *>> doc_ptrs(pool.size());
+    std::vector<std::vector<int>>              doc_ids(pool.size());
+
+    // docno lookups stay on this thread
+    auto &                 queries = qtfile.get_queries();
+    std::vector<query_run> runs(queries.size());
+    for (size_t q = 0; q < queries.size(); ++q) {
+        auto &run         = runs[q];
+        run.qry           = &queries[q];
+        run.stage0_scores = trec_run.get_scores(run.qry->id);
+        run.docnos        = trec_run.get_result(run.qry->id);
+        run.docids        = resolver.document_ids(run.docnos);
+        if (reads_query_features && !query_features.empty() &&
+            query_features.find(run.qry->id) == query_features.end()) {
+            std::cerr << "qid: " << run.qry->id << ", no query features" << std::endl;
+        }
+    }
+
+    pool.parallel_for(runs.size(), [&](size_t q, size_t t) {
+        auto &     run = runs[q];
+        size_t     n   = run.docids.size();
+        const auto qf  = query_features.find(run.qry->id);
+
+        // dense rows of scaled features, filled in as the stages read them
+        std::vector<double> x(n * model.features(), 0.0);
+        std::vector<double> preds(n, 0.0);
+        std::vector<size_t> indexes(n);
+        std::vector<double> scores;
+        for (size_t i = 0; i < n; ++i) {
+            indexes[i] = i;
+        }
+
+        run.stats.resize(plans.size());
+        for (size_t s = 0; s < plans.size(); ++s) {
+            auto        start = clock::now();
+            auto &      plan  = plans[s];
+            const auto &stage = model.stages()[s];
+            indexes           = model.prune(s, preds, indexes);
+
+            if (!plan.doc_features.empty()) {
+                auto &docs = doc_ptrs[t];
+                auto &ids  = doc_ids[t];
+                docs.clear();
+                ids.clear();
+                for (size_t i : indexes) {
+                    ids.push_back(run.docids[i]);
+                    docs.push_back(&fwd_idx[ids.back()]);
+                }
+                auto &ex = extractors[s][t];
+                ex.score_batch(*run.qry, docs, ids);
+                for (size_t k = 0; k < indexes.size(); ++k) {
+                    size_t i     = indexes[k];
+                    auto   entry = ex.entry(k, run.docids[i], *docs[k], run.stage0_scores[i]);
+
+                    double *row = &x[i * model.features()];
+                    size_t  f   = 0;
+                    entry.visit([&](const char *, double value) {
+                        if (plan.doc_mask[f]) {
+                            row[f] = model.scale(f, value);
+                        }
+                        ++f;
+                    });
+                }
+            }
+            if (qf != query_features.end()) {
+                for (size_t f : plan.query_features) {
+                    size_t col = f - doc_names.size();
+                    double v   = col < qf->second.size() ? model.scale(f, qf->second[col]) : 0.0;
+                    for (size_t i : indexes) {
+                        x[i * model.features() + f] = v;
+                    }
+                }
+            }
+
+            scores.resize(indexes.size());
+            for (size_t k = 0; k < indexes.size(); ++k) {
+                scores[k] = stage.score(&x[indexes[k] * model.features()]);
+            }
+            model.update(preds, indexes, scores);
+
+            auto &stats = run.stats[s];
+            stats.docs += indexes.size();
+            stats.values +=
+                (plan.doc_features.size() + plan.query_features.size()) * indexes.size();
+            stats.time += clock::now() - start;
+        }
+
+        // every candidate is ranked, pruned ones by the score of the last stage they reached
+        std::vector<size_t> order(n);
+        for (size_t i = 0; i < n; ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(
+            order.begin(), order.end(), [&](size_t a, size_t b) { return preds[a] > preds[b]; });
+        char buf[64];
+        run.rows.clear();
+        for (size_t r = 0; r < n; ++r) {
+            run.rows += std::to_string(run.qry->id) + " Q0 " + run.docnos[order[r]];
+            snprintf(buf, sizeof(buf), " %zu %f ", r + 1, preds[order[r]]);
+            run.rows += buf;
+            run.rows += run_id + "\n";
+        }
+    });
+
+    std::ofstream outfile(output_file);
+    if (!outfile.is_open()) {
+        std::cerr << "Could not open file: " << output_file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::vector<stage_stats> total(plans.size());
+    for (auto &&run : runs) {
+        outfile << run.rows;
+        for (size_t s = 0; s < plans.size(); ++s) {
+            total[s].docs += run.stats[s].docs;
+            total[s].values += run.stats[s].values;
+            total[s].time += run.stats[s].time;
+        }
+    }
+
+    // time is summed over the threads
+    for (size_t s = 0; s < plans.size(); ++s) {
+        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(total[s].time);
+        std::cerr << "stage " << s + 1 << ": " << total[s].docs << " docs, "
+                  << plans[s].doc_features.size() + plans[s].query_features.size()
+                  << " new features, " << total[s].values << " feature values in " << time.count()
+                  << " ms" << std::endl;
+    }
+    return 0;
+}
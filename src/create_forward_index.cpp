@@ -4,6 +4,8 @@
 
 #include "CLI/CLI.hpp"
 #include "cereal/archives/binary.hpp"
+#include "docno_map.hpp"
+#include "field_id.hpp"
 #include "forward_index.hpp"
 
 size_t url_slash_count(const std::string &url) {
@@ -32,10 +34,14 @@ static const std::vector<std::string> _fields = {"body", "title", "heading", "in
 int main(int argc, char const *argv[]) {
     std::string repo_path;
     std::string forward_index_file;
+    std::string docno_map_file;
+    std::string fields_file;
 
     CLI::App app{"Inverted index generator."};
     app.add_option("repo_path", repo_path, "Indri repo path")->required();
     app.add_option("forward_index_file", forward_index_file, "Forward index file")->required();
+    app.add_option("--docno-map", docno_map_file, "Write the docno to document id map");
+    app.add_option("--fields", fields_file, "Write the field ids of the index");
     CLI11_PARSE(app, argc, argv);
 
     std::ofstream               os(forward_index_file, std::ios::binary);
@@ -49,10 +55,20 @@ int main(int argc, char const *argv[]) {
     indri::api::QueryEnvironment indri_env;
     indri_env.addIndex(repo_path);
 
+    if (!fields_file.empty()) {
+        FieldIdMap field_id_map;
+        for (const std::string &field_str : indri_env.fieldList()) {
+            field_id_map[field_str] = index->field(field_str);
+        }
+        write_field_manifest(fields_file, field_id_map);
+    }
+
     ForwardIndex fwd_idx;
     fwd_idx.push_back({});
     uint64_t                            docid = index->documentBase();
     indri::index::TermListFileIterator *iter  = index->termListFileIterator();
+    // the docno of id d at index d
+    std::vector<std::string> docnos(docid);
     iter->startIteration();
     auto *priorIt = repo.priorListIterator("pagerank");
     priorIt->startIteration();
@@ -65,6 +81,10 @@ int main(int argc, char const *argv[]) {
 
         document.set_pagerank(priorEntry->score);
         document.set_url_stats({url_slash_count(url.at(0)), url.at(0).size()});
+        if (!docno_map_file.empty()) {
+            docnos.push_back(
+                indri_env.documentMetadata(std::vector<lemur::api::DOCID_T>{docid}, "docno").at(0));
+        }
 
         std::vector<uint32_t> terms(doc_terms.begin(), doc_terms.end());
         document.set_terms(terms);
@@ -123,5 +143,8 @@ int main(int argc, char const *argv[]) {
     }
     delete iter;
     archive(fwd_idx);
+    if (!docno_map_file.empty()) {
+        docno_map::write(docno_map_file, docnos);
+    }
     return 0;
 }
@@ -0,0 +1,73 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "CLI/CLI.hpp"
+#include "cereal/archives/binary.hpp"
+
+#include "doc_lens.hpp"
+#include "impact_index.hpp"
+#include "inverted_index.hpp"
+#include "lexicon.hpp"
+
+int main(int argc, char const *argv[]) {
+    std::string inverted_index_file;
+    std::string doc_lens_file;
+    std::string lexicon_file;
+    std::string impact_index_file;
+    ImpactIndex impact_idx;
+
+    CLI::App app{"Impact-ordered BM25 index for score-at-a-time retrieval."};
+    app.add_option("inverted_index_file", inverted_index_file, "Inverted index file")->required();
+    app.add_option("doc_lens_file", doc_lens_file, "Document lens file")->required();
+    app.add_option("lexicon_file", lexicon_file, "Lexicon file")->required();
+    app.add_option("impact_index_file", impact_index_file, "Output impact index file")->required();
+    app.add_option("--k1", impact_idx.bm25.k1, "BM25 k1", true);
+    app.add_option("--b", impact_idx.bm25.b, "BM25 b", true);
+    app.add_option("--bits", impact_idx.bits, "Bits per impact", true);
+    CLI11_PARSE(app, argc, argv);
+
+    if (impact_idx.bits < 1 || impact_idx.bits > 16) {
+        std::cerr << "--bits must be between 1 and 16" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    using clock = std::chrono::high_resolution_clock;
+    auto start  = clock::now();
+
+    InvertedIndex inv_idx;
+    DocLens       doc_lens;
+    Lexicon       lexicon;
+    {
+        std::ifstream              ifs_inv(inverted_index_file);
+        cereal::BinaryInputArchive iarchive_inv(ifs_inv);
+        iarchive_inv(inv_idx);
+    }
+    {
+        std::ifstream              ifs_len(doc_lens_file);
+        cereal::BinaryInputArchive iarchive_len(ifs_len);
+        iarchive_len(doc_lens);
+    }
+    {
+        std::ifstream              ifs_lex(lexicon_file);
+        cereal::BinaryInputArchive iarchive_lex(ifs_lex);
+        iarchive_lex(lexicon);
+    }
+
+    impact_idx.build(inv_idx, doc_lens, lexicon);
+
+    std::ofstream               os(impact_index_file, std::ios::binary);
+    cereal::BinaryOutputArchive archive(os);
+    archive(impact_idx);
+
+    size_t segments = 0;
+    for (auto &&list : impact_idx.lists) {
+        segments += list.segments.size();
+    }
+    auto stop = clock::now();
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    std::cout << segments << " segments of " << impact_idx.lists.size() << " lists in "
+              << time.count() << " ms" << std::endl;
+    return 0;
+}
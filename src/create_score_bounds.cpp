@@ -0,0 +1,69 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "CLI/CLI.hpp"
+#include "cereal/archives/binary.hpp"
+
+#include "doc_lens.hpp"
+#include "inverted_index.hpp"
+#include "lexicon.hpp"
+#include "score_bounds.hpp"
+
+int main(int argc, char const *argv[]) {
+    std::string inverted_index_file;
+    std::string doc_lens_file;
+    std::string lexicon_file;
+    std::string score_bounds_file;
+    ScoreBounds bounds;
+
+    CLI::App app{"BM25 bounds and block encoded lists of an inverted index for top-k retrieval."};
+    app.add_option("inverted_index_file", inverted_index_file, "Inverted index file")->required();
+    app.add_option("doc_lens_file", doc_lens_file, "Document lens file")->required();
+    app.add_option("lexicon_file", lexicon_file, "Lexicon file")->required();
+    app.add_option("score_bounds_file", score_bounds_file, "Output score bounds file")->required();
+    app.add_option("--k1", bounds.bm25.k1, "BM25 k1", true);
+    app.add_option("--b", bounds.bm25.b, "BM25 b", true);
+    app.add_option("--block-size", bounds.block_size, "Postings per block", true);
+    CLI11_PARSE(app, argc, argv);
+
+    if (bounds.block_size == 0) {
+        std::cerr << "--block-size must be positive" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    using clock = std::chrono::high_resolution_clock;
+    auto start  = clock::now();
+
+    InvertedIndex inv_idx;
+    DocLens       doc_lens;
+    Lexicon       lexicon;
+    {
+        std::ifstream              ifs_inv(inverted_index_file);
+        cereal::BinaryInputArchive iarchive_inv(ifs_inv);
+        iarchive_inv(inv_idx);
+    }
+    {
+        std::ifstream              ifs_len(doc_lens_file);
+        cereal::BinaryInputArchive iarchive_len(ifs_len);
+        iarchive_len(doc_lens);
+    }
+    {
+        std::ifstream              ifs_lex(lexicon_file);
+        cereal::BinaryInputArchive iarchive_lex(ifs_lex);
+        iarchive_lex(lexicon);
+    }
+
+    bounds.build(inv_idx, doc_lens, lexicon);
+
+    std::ofstream               os(score_bounds_file, std::ios::binary);
+    cereal::BinaryOutputArchive archive(os);
+    archive(bounds);
+
+    auto stop = clock::now();
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    std::cout << "Bounds of " << bounds.terms.size() << " lists in " << time.count() << " ms"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "cereal/archives/binary.hpp"
+
+#include "doc_entry.hpp"
+#include "docno_resolver.hpp"
+#include "feature_pipeline.hpp"
+#include "field_id.hpp"
+#include "forward_index.hpp"
+#include "lexicon.hpp"
+#include "static_features.hpp"
+
+int main(int argc, char const *argv[]) {
+    std::string repo_path;
+    std::string forward_index_file;
+    std::string lexicon_file;
+    std::string static_features_file;
+    std::string docno_map_file;
+    std::string fields_file;
+
+    CLI::App app{"Query-independent document features for generate_document_features."};
+    app.add_option("repo_path", repo_path, "Indri repo path, unused with --docno-map and --fields")
+        ->required();
+    app.add_option("forward_index_file", forward_index_file, "Forward index file")->required();
+    app.add_option("lexicon_file", lexicon_file, "Lexicon file")->required();
+    app.add_option("static_features_file", static_features_file, "Output static features file")
+        ->required();
+    app.add_option("--docno-map", docno_map_file, "Docno map from create_forward_index");
+    app.add_option("--fields", fields_file, "Field ids from create_forward_index");
+    CLI11_PARSE(app, argc, argv);
+
+    docno_resolver resolver(repo_path, docno_map_file, fields_file);
+
+    using clock = std::chrono::high_resolution_clock;
+    auto start  = clock::now();
+
+    ForwardIndex fwd_idx;
+    Lexicon      lexicon;
+    {
+        std::ifstream              ifs_fwd(forward_index_file);
+        cereal::BinaryInputArchive iarchive_fwd(ifs_fwd);
+        iarchive_fwd(fwd_idx);
+    }
+    {
+        std::ifstream              ifs_lex(lexicon_file);
+        cereal::BinaryInputArchive iarchive_lex(ifs_lex);
+        iarchive_lex(lexicon);
+    }
+
+    // the fields of generate_document_features, a table is only valid with the same ids
+    FieldIdMap                     field_id_map;
+    const std::vector<std::string> idx_fields = {
+        "title", "heading", "mainbody", "inlink", "applet", "object", "embed"};
+    for (const std::string &field_str : idx_fields) {
+        int field_id = resolver.field(field_str);
+        if (field_id < 1) {
+            std::cerr << "field '" << field_str << "' does not exist" << std::endl;
+        }
+        field_id_map.insert(std::make_pair(field_str, field_id));
+    }
+
+    // a view of no query term gathers the fields only
+    query_train        no_query{};
+    query_doc_view     view(field_id_map);
+    doc_stream_feature f_stream;
+    document_features  features;
+    batch_scorer       scorer(lexicon);
+    StaticFeatures     statics;
+    statics.set_collection(lexicon, view, fwd_idx.size());
+    for (size_t docid = 0; docid < fwd_idx.size(); ++docid) {
+        view.gather(no_query, fwd_idx[docid]);
+        auto doc = document_entry(docid, fwd_idx[docid], 0);
+        f_stream.lengths(doc, view);
+        features.tag_counts(doc, view);
+        statics.add(doc, view, scorer);
+    }
+
+    std::ofstream               os(static_features_file, std::ios::binary);
+    cereal::BinaryOutputArchive archive(os);
+    archive(statics);
+
+    auto stop = clock::now();
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    std::cout << "Static features of " << statics.rows() << " documents in " << time.count()
+              << " ms" << std::endl;
+    return 0;
+}
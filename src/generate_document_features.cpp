@@ -1,17 +1,23 @@
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "CLI/CLI.hpp"
 #include "cereal/archives/binary.hpp"
 
 #include "doc_entry.hpp"
+#include "docno_resolver.hpp"
+#include "feature_pipeline.hpp"
+#include "feature_store.hpp"
 #include "field_id.hpp"
-
-#include "features/features.hpp"
 #include "forward_index.hpp"
 
 #include "lexicon.hpp"
@@ -19,36 +25,526 @@
 #include "query_train_file.hpp"
 #include "trec_run_file.hpp"
 
-#include "query_environment_adapter.hpp"
+#include "async_writer.hpp"
+#include "npy_format.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+/* Documents of one query scored as a unit of work, so long runs are spread over the threads. */
+constexpr size_t chunk_size = 500;
+/* Chunks scored between two writes to the output file. */
+constexpr size_t batch_chunks = 256;
+
+/* The TREC run of one query, resolved to Indri document ids. */
+struct query_run {
+    query_train *            qry;
+    std::vector<double>      stage0_scores;
+    std::vector<int>         labels;
+    std::vector<std::string> docnos;
+    std::vector<docid_t>     docids;
+    // first row of the run in the store rows of the documents
+    size_t                   first_row = 0;
+    // positions of the run to score in scoring order, and the row of each position in
+    // document-major order
+    std::vector<size_t>      order;
+    std::vector<std::string> rows;
+};
+
+/*
+ * Documents at positions [begin, end) of the `order` of a run and their rows, as text or binary
+ * records, unless the rows go to the run.
+ */
+struct chunk {
+    size_t                                       run;
+    size_t                                       begin;
+    size_t                                       end;
+    std::string                                  rows;
+    std::chrono::high_resolution_clock::duration time;
+};
+
+/*
+ * Chunks scoring the documents of `runs` by increasing docid: tiles of `chunk_size` distinct
+ * documents, each scored for every query retrieving them before the next tile, with the documents
+ * of a query in a tile as one chunk. The runs are ordered by docid and get a row per document.
+ */
+std::vector<chunk> document_major_chunks(std::vector<query_run> &runs) {
+    std::vector<docid_t> docids;
+    for (auto &&run : runs) {
+        docids.insert(docids.end(), run.docids.begin(), run.docids.end());
+        auto by_docid = [&](size_t a, size_t b) { return run.docids[a] < run.docids[b]; };
+        std::stable_sort(run.order.begin(), run.order.end(), by_docid);
+        run.rows.assign(run.docids.size(), std::string());
+    }
+    std::sort(docids.begin(), docids.end());
+    docids.erase(std::unique(docids.begin(), docids.end()), docids.end());
+
+    std::vector<chunk>  chunks;
+    std::vector<size_t> next(runs.size(), 0);
+    for (size_t first = 0; first < docids.size(); first += chunk_size) {
+        size_t last = std::min(first + chunk_size, docids.size()) - 1;
+        for (size_t r = 0; r < runs.size(); ++r) {
+            auto &run = runs[r];
+            chunk c;
+            c.run   = r;
+            c.begin = next[r];
+            while (next[r] < run.order.size() && run.docids[run.order[next[r]]] <= docids[last]) {
+                ++next[r];
+            }
+            c.end = next[r];
+            if (c.end > c.begin) {
+                chunks.push_back(c);
+            }
+        }
+    }
+    return chunks;
+}
+
+/* Removes the elements `x` of `v` with `pred(x)`. */
+template <class T, class P>
+void erase_if(std::vector<T> &v, P &&pred) {
+    v.erase(std::remove_if(v.begin(), v.end(), pred), v.end());
+}
+
+/* The settings of the parameter sweep, whose columns follow the `doc_entry` ones. */
+struct sweep {
+    std::vector<batch_scorer::bm25_params> bm25;
+    std::vector<double>                    lm_mu;
+    std::vector<proximity_window>          windows;
+    std::vector<int>                       tp_dist_windows;
+};
+
+/* The sweep of the command line options, exits on an invalid one. */
+sweep make_sweep(const std::vector<double> &bm25_k1,
+                 const std::vector<double> &bm25_b,
+                 const std::vector<double> &lm_mu,
+                 const std::vector<int> &   bigram_windows,
+                 std::vector<std::string>   bigram_modes,
+                 const std::vector<int> &   tp_dist_windows) {
+    if (bm25_k1.empty() != bm25_b.empty()) {
+        std::cerr << "A BM25 sweep needs both --bm25-k1 and --bm25-b" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (int w : bigram_windows) {
+        if (w < 1) {
+            std::cerr << "--bigram-windows must be positive" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int w : tp_dist_windows) {
+        if (w < 1) {
+            std::cerr << "--tp-dist-windows must be positive" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    sweep s;
+    s.bm25            = batch_scorer::grid(bm25_k1, bm25_b);
+    s.lm_mu           = lm_mu;
+    s.tp_dist_windows = tp_dist_windows;
+    if (bigram_modes.empty()) {
+        bigram_modes.push_back("u");
+    }
+    for (auto &&mode : bigram_modes) {
+        if (mode != "u" && mode != "o") {
+            std::cerr << "Unknown bigram window mode: " << mode << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        for (int w : bigram_windows) {
+            proximity_window window;
+            window.window  = w;
+            window.ordered = mode == "o";
+            s.windows.push_back(window);
+        }
+    }
+    return s;
+}
+
+/*
+ * A feature store over the rows of a run. The extractors only run for the columns the store is
+ * missing a value of, and only for the positions of the run missing one.
+ */
+struct store_plan {
+    feature_store       store;
+    // first position of each query, and the store row of each position, query after query
+    std::vector<size_t> row_begin;
+    std::vector<size_t> rows;
+    // store column of each output column, and whether this run computes it
+    std::vector<size_t> columns;
+    std::vector<bool>   computed;
+    // positions this run scores
+    std::vector<bool>   pending;
+    // store column of each sweep column the extractors compute
+    std::vector<size_t> sweep_columns;
+};
+
+/*
+ * Reads the store of `file` for the runs of `queries` and the output `columns`. The settings of
+ * `s` whose columns the store holds are dropped, and the extractors of the others are returned.
+ */
+pipeline open_store(store_plan &                    plan,
+                    const std::string &             file,
+                    const Lexicon &                 lexicon,
+                    const FieldIdMap &              field_id_map,
+                    std::vector<query_train> &      queries,
+                    trec_run_file &                 trec_run,
+                    const std::vector<std::string> &columns,
+                    sweep &                         s) {
+    auto &store = plan.store;
+    store.read(file);
+    store.index(lexicon, query_doc_view(field_id_map));
+    for (auto &&qry : queries) {
+        store.query(qry.id, qry.stems);
+        plan.row_begin.push_back(plan.rows.size());
+        for (auto &&docno : trec_run.get_result(qry.id)) {
+            plan.rows.push_back(store.row(qry.id, docno));
+        }
+    }
+    std::vector<std::string> stale;
+    std::vector<size_t>      stale_columns;
+    for (auto &&name : columns) {
+        size_t c = store.column(name, extractor_version(extractor_of(name)));
+        plan.columns.push_back(c);
+        plan.computed.push_back(!store.complete(c, plan.rows));
+        if (plan.computed.back()) {
+            stale.push_back(name);
+            stale_columns.push_back(c);
+        }
+    }
+    size_t missing = 0;
+    for (size_t r : plan.rows) {
+        plan.pending.push_back(store.missing(r, stale_columns));
+        missing += plan.pending.back();
+    }
+    // a sweep setting is dropped once the store holds its columns
+    auto fresh = [&](const std::string &name) {
+        return std::find(stale.begin(), stale.end(), name) == stale.end();
+    };
+    erase_if(s.bm25, [&](const batch_scorer::bm25_params &p) {
+        return fresh(batch_scorer::sweep_name(p));
+    });
+    erase_if(s.lm_mu, [&](double mu) { return fresh(batch_scorer::sweep_name(mu)); });
+    erase_if(s.windows, [&](const proximity_window &w) { return fresh(w.name()); });
+    erase_if(s.tp_dist_windows,
+             [&](int w) { return fresh(doc_proximity_feature::tp_dist_name(w)); });
+    std::cerr << "Computing " << stale.size() << " of " << columns.size() << " columns of "
+              << missing << " of " << plan.rows.size() << " rows for the store" << std::endl;
+    return select_pipeline(stale);
+}
+
+/*
+ * Writes the rows of the runs of `queries` from the store: every column, whether computed now or
+ * by an earlier run, but the score of a row in the run, which differs between two rows of a docno
+ * listed twice. Returns the number of rows.
+ */
+size_t write_store_rows(store_plan &                    plan,
+                        std::vector<query_train> &      queries,
+                        trec_run_file &                 trec_run,
+                        const std::vector<std::string> &columns,
+                        const npy_layout *              npy,
+                        async_writer &                  outfile) {
+    std::vector<double> row;
+    size_t              rows_written = 0;
+    size_t stage0 = std::find(columns.begin(), columns.end(), "stage0_score") - columns.begin();
+    for (size_t q = 0; q < queries.size(); ++q) {
+        auto               labels = trec_run.get_labels(queries[q].id);
+        auto               scores = trec_run.get_scores(queries[q].id);
+        auto               docnos = trec_run.get_result(queries[q].id);
+        std::string        out;
+        std::ostringstream rows;
+        rows << std::fixed << std::setprecision(5);
+        for (size_t j = 0; j < docnos.size(); ++j) {
+            size_t r = plan.rows[plan.row_begin[q] + j];
+            row.clear();
+            for (size_t c : plan.columns) {
+                row.push_back(plan.store.value(c, r));
+            }
+            row[stage0] = scores[j];
+            if (npy) {
+                npy->append(out, labels[j], queries[q].id, docnos[j], row.data());
+                continue;
+            }
+            rows << labels[j] << "," << queries[q].id << "," << docnos[j];
+            for (double value : row) {
+                rows << "," << value;
+            }
+            rows << '\n';
+        }
+        outfile.write(npy ? std::move(out) : rows.str());
+        rows_written += docnos.size();
+    }
+    return rows_written;
+}
+
+/*
+ * What scoring the runs reads, shared by the threads, and where their rows go: the store if there
+ * is one, else the output as .npy records with a layout, CSV text without.
+ */
+struct scoring {
+    const ForwardIndex &        fwd_idx;
+    docno_resolver &            resolver;
+    trec_run_file &             trec_run;
+    thread_pool &               pool;
+    std::vector<extractor_set> &extractors;
+    store_plan *                plan;
+    const npy_layout *          npy;
+    bool                        document_order;
+};
+
+/* Tables one thread keeps from one chunk to the next. */
+struct thread_tables {
+    std::vector<const Document *> docs;
+    std::vector<int>              ids;
+    std::vector<double>           values;
+};
+
+/* Scores chunk `c` of `run` on thread `t` and keeps its rows. */
+void score_chunk(scoring &ctx, query_run &run, chunk &c, size_t t, thread_tables &tables) {
+    using clock = std::chrono::high_resolution_clock;
+    auto start  = clock::now();
+
+    auto &extractors = ctx.extractors[t];
+    auto &docs       = tables.docs;
+    auto &ids        = tables.ids;
+    docs.clear();
+    ids.clear();
+    for (size_t p = c.begin; p < c.end; ++p) {
+        ids.push_back(run.docids[run.order[p]]);
+        docs.push_back(&ctx.fwd_idx[ids.back()]);
+    }
+    extractors.score_batch(*run.qry, docs, ids);
+
+    std::ostringstream rows;
+    rows << std::fixed << std::setprecision(5);
+    c.rows.clear();
+    for (size_t p = c.begin; p < c.end; ++p) {
+        size_t      j         = run.order[p];
+        size_t      k         = p - c.begin;
+        auto const  docid     = run.docids[j];
+        const auto &doc_idx   = *docs[k];
+        auto        doc_entry = extractors.entry(k, docid, doc_idx, run.stage0_scores[j]);
+
+        if (ctx.plan) {
+            auto & plan = *ctx.plan;
+            size_t r    = plan.rows[run.first_row + j];
+            size_t f    = 0;
+            doc_entry.visit([&](const char *, double value) {
+                if (plan.computed[f]) {
+                    plan.store.set(plan.columns[f], r, value);
+                }
+                ++f;
+            });
+            size_t s = 0;
+            extractors.visit_sweep(
+                k, [&](double value) { plan.store.set(plan.sweep_columns[s++], r, value); });
+        } else if (ctx.npy) {
+            auto &row  = tables.values;
+            auto  push = [&](double value) { row.push_back(value); };
+            row.clear();
+            doc_entry.visit([&](const char *, double value) { push(value); });
+            extractors.visit_sweep(k, push);
+            auto &out = ctx.document_order ? run.rows[j] : c.rows;
+            ctx.npy->append(out, run.labels[j], run.qry->id, run.docnos[j], row.data());
+        } else {
+            rows << run.labels[j] << "," << run.qry->id << "," << run.docnos[j] << doc_entry;
+            extractors.visit_sweep(k, [&](double value) { rows << "," << value; });
+            rows << '\n';
+            if (ctx.document_order) {
+                run.rows[j] = rows.str();
+                rows.str("");
+            }
+        }
+    }
+    if (!ctx.npy && !ctx.document_order) {
+        c.rows = rows.str();
+    }
+    c.time = clock::now() - start;
+}
+
+/*
+ * Scores the runs of `queries`, whole queries at a time up to `batch_chunks` chunks, and writes
+ * their rows in query file and run order. Returns the number of rows written, none with a store.
+ */
+size_t score_runs(scoring &ctx, std::vector<query_train> &queries, async_writer &outfile) {
+    using clock         = std::chrono::high_resolution_clock;
+    bool   stored       = ctx.plan != nullptr;
+    size_t rows_written = 0;
+
+    std::vector<thread_tables> tables(ctx.pool.size());
+    std::vector<query_run>     runs;
+    std::vector<chunk>         chunks;
+    for (size_t next = 0; next < queries.size();) {
+        // docno lookups stay on this thread
+        runs.clear();
+        chunks.clear();
+        while (next < queries.size() && chunks.size() < batch_chunks) {
+            auto &    qry = queries[next];
+            query_run run;
+            run.qry           = &qry;
+            run.first_row     = stored ? ctx.plan->row_begin[next] : 0;
+            run.stage0_scores = ctx.trec_run.get_scores(qry.id);
+            run.labels        = ctx.trec_run.get_labels(qry.id);
+            run.docnos        = ctx.trec_run.get_result(qry.id);
+            run.docids        = ctx.resolver.document_ids(run.docnos);
+            ++next;
+            for (size_t j = 0; j < run.docids.size(); ++j) {
+                if (!stored || ctx.plan->pending[run.first_row + j]) {
+                    run.order.push_back(j);
+                }
+            }
+            for (size_t begin = 0; begin < run.order.size(); begin += chunk_size) {
+                chunk c;
+                c.run   = runs.size();
+                c.begin = begin;
+                c.end   = std::min(begin + chunk_size, run.order.size());
+                chunks.push_back(c);
+            }
+            runs.push_back(std::move(run));
+        }
+        if (ctx.document_order) {
+            chunks = document_major_chunks(runs);
+        }
+
+        ctx.pool.parallel_for(chunks.size(), [&](size_t i, size_t t) {
+            score_chunk(ctx, runs[chunks[i].run], chunks[i], t, tables[t]);
+        });
+
+        // time is summed over the threads
+        std::vector<clock::duration> times(runs.size(), clock::duration(0));
+        for (auto &&c : chunks) {
+            times[c.run] += c.time;
+        }
+        size_t c = 0;
+        for (size_t r = 0; r < runs.size(); ++r) {
+            if (ctx.document_order && !stored) {
+                std::string rows;
+                for (auto &&row : runs[r].rows) {
+                    rows += row;
+                }
+                outfile.write(std::move(rows));
+            }
+            // the chunks of a run are consecutive and in run order
+            for (; !ctx.document_order && !stored && c < chunks.size() && chunks[c].run == r;
+                 ++c) {
+                outfile.write(std::move(chunks[c].rows));
+            }
+            if (!stored) {
+                rows_written += runs[r].docids.size();
+            }
+            auto load_time = std::chrono::duration_cast<std::chrono::milliseconds>(times[r]);
+            std::cerr << "qid: " << runs[r].qry->id << ", " << runs[r].order.size() << " docs in "
+                      << load_time.count() << " ms" << std::endl;
+        }
+    }
+    return rows_written;
+}
+} // namespace
 
 int main(int argc, char **argv) {
 
-    std::string query_file;
-    std::string trec_file;
-    std::string repo_path;
-    std::string forward_index_file;
-    std::string lexicon_file;
-    std::string output_file;
+    std::string              query_file;
+    std::string              trec_file;
+    std::string              repo_path;
+    std::string              forward_index_file;
+    std::string              lexicon_file;
+    std::string              output_file;
+    size_t                   threads = 1;
+    std::vector<double>      bm25_k1;
+    std::vector<double>      bm25_b;
+    std::vector<double>      lm_mu;
+    std::vector<int>         bigram_windows;
+    std::vector<std::string> bigram_modes;
+    std::vector<int>         tp_dist_windows;
+    std::string              format = "csv";
+    std::string              features_file;
+    std::string              costs_file;
+    std::string              query_costs_file;
+    std::string              details_file;
+    std::string              docno_map_file;
+    std::string              fields_file;
+    std::string              store_file;
+    std::string              static_features_file;
+    std::string              feature_names_file;
+    bool                     document_order = false;
 
     CLI::App app{"Document features generation."};
     app.add_option("query_file", query_file, "Query file")->required();
     app.add_option("trec_file", trec_file, "TREC run file")->required();
-    app.add_option("repo_path", repo_path, "Indri repo path")->required();
+    app.add_option("repo_path", repo_path, "Indri repo path, unused with --docno-map and --fields")
+        ->required();
     app.add_option("forward_index_file", forward_index_file, "Forward index file")->required();
     app.add_option("lexicon_file", lexicon_file, "Lexicon file")->required();
     app.add_option("output_file", output_file, "Output file")->required();
+    app.add_option("-j,--threads", threads, "Number of threads", true);
+    app.add_option("--bm25-k1", bm25_k1, "BM25 k1 values of the sweep grid");
+    app.add_option("--bm25-b", bm25_b, "BM25 b values of the sweep grid");
+    app.add_option("--lm-mu", lm_mu, "LM Dirichlet mu values of the sweep");
+    app.add_option("--bigram-windows", bigram_windows, "Bigram window sizes of the sweep");
+    app.add_option("--bigram-modes",
+                   bigram_modes,
+                   "Bigram window modes of the sweep: u (unordered, the default), o (ordered)");
+    app.add_option("--tp-dist-windows", tp_dist_windows, "TP-dist window sizes of the sweep");
+    app.add_option("--format", format, "Output format: csv, float32 or float64 (.npy)", true);
+    app.add_option("--features",
+                   features_file,
+                   "Only run the extractors of the features named in this file. Every column of "
+                   "those extractors is filled, the columns of the others are zero");
+    app.add_option("--profile",
+                   costs_file,
+                   "Time the extractors and write the cycles per document of each document "
+                   "feature in the costs.txt format, a complete costs.txt with --query-costs");
+    app.add_option("--query-costs",
+                   query_costs_file,
+                   "Costs of the query features, one per line in feature order, written after "
+                   "those of --profile");
+    app.add_option("--profile-details",
+                   details_file,
+                   "Write the cycles of each extractor by query and document length as CSV");
+    app.add_option("--docno-map", docno_map_file, "Docno map from create_forward_index");
+    app.add_option("--fields", fields_file, "Field ids from create_forward_index");
+    app.add_flag("--document-order",
+                 document_order,
+                 "Score the documents by docid, each for all the queries retrieving it in turn; "
+                 "rows stay in run order");
+    app.add_option("--store",
+                   store_file,
+                   "Feature store to compute only the columns it is missing or holds from an older "
+                   "extractor into, the output is then written from it");
+    app.add_option("--static-features",
+                   static_features_file,
+                   "Static features from create_static_features, copied rather than computed");
+    app.add_option("--feature-names",
+                   feature_names_file,
+                   "Exit unless this names file starts with the document features in output order");
     CLI11_PARSE(app, argc, argv);
 
-    std::ofstream outfile(output_file, std::ofstream::app);
-    outfile << std::fixed << std::setprecision(5);
-
-    query_environment         indri_env;
-    query_environment_adapter qry_env(&indri_env);
-    qry_env.add_index(repo_path);
+    // the query features are not extracted here, their costs are copied as given
+    std::vector<std::string> query_costs;
+    if (!query_costs_file.empty()) {
+        if (costs_file.empty()) {
+            std::cerr << "--query-costs requires --profile" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        query_costs = read_feature_names(query_costs_file);
+    } else if (!costs_file.empty()) {
+        std::cerr << "Without --query-costs, " << costs_file << " only has the costs of the "
+                  << doc_entry::names().size() << " document features" << std::endl;
+    }
+    if (!feature_names_file.empty()) {
+        check_feature_names(read_feature_names(feature_names_file));
+    }
+    auto settings =
+        make_sweep(bm25_k1, bm25_b, lm_mu, bigram_windows, bigram_modes, tp_dist_windows);
+    if (format != "csv" && format != "float32" && format != "float64") {
+        std::cerr << "Unknown output format: " << format << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    bool binary = format != "csv";
+    bool stored = !store_file.empty();
+    if (stored && !features_file.empty()) {
+        std::cerr << "--features and --store cannot be combined" << std::endl;
+        exit(EXIT_FAILURE);
+    }
 
-    indri::collection::Repository repo;
-    repo.openRead(repo_path);
-    auto index = (*repo.indexes())[0];
+    docno_resolver resolver(repo_path, docno_map_file, fields_file);
 
     using clock = std::chrono::high_resolution_clock;
     auto start  = clock::now();
@@ -75,6 +571,13 @@ int main(int argc, char **argv) {
     load_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
     std::cerr << "Loaded " << lexicon_file << " in " << load_time.count() << " ms" << std::endl;
 
+    StaticFeatures statics;
+    if (!static_features_file.empty()) {
+        std::ifstream              ifs_static(static_features_file);
+        cereal::BinaryInputArchive iarchive_static(ifs_static);
+        iarchive_static(statics);
+    }
+
     // load query file
     std::ifstream ifs(query_file);
     if (!ifs.is_open()) {
@@ -92,77 +595,134 @@ int main(int argc, char **argv) {
     ifs.close();
     ifs.clear();
 
+    // field names are resolved to Indri ids once, extractors only index field slots
     FieldIdMap                     field_id_map;
     const std::vector<std::string> idx_fields = {
         "title", "heading", "mainbody", "inlink", "applet", "object", "embed"};
     for (const std::string &field_str : idx_fields) {
-        int field_id = index->field(field_str);
+        int field_id = resolver.field(field_str);
+        if (field_id < 1) {
+            std::cerr << "field '" << field_str << "' does not exist" << std::endl;
+        }
         field_id_map.insert(std::make_pair(field_str, field_id));
     }
 
-    document_features           features;
-    doc_bm25_atire_feature      f_bm25_atire(lexicon);
-    doc_bm25_trec3_feature      f_bm25_trec3(lexicon);
-    doc_bm25_trec3_kmax_feature f_bm25_trec3_kmax(lexicon);
-    doc_proximity_feature       prox_feature(lexicon);
-    doc_lm_dir_2500_feature     f_lmds_2500(lexicon);
-    doc_lm_dir_1500_feature     f_lmds_1500(lexicon);
-    doc_lm_dir_1000_feature     f_lmds_1000(lexicon);
-    doc_tfidf_feature           tfidf_feature(lexicon);
-    doc_prob_feature            prob_feature(lexicon);
-    doc_be_feature              be_feature(lexicon);
-    doc_dph_feature             dph_feature(lexicon);
-    doc_dfr_feature             dfr_feature(lexicon);
-    doc_stream_feature          f_stream;
-    doc_tpscore_feature         f_tpscore(lexicon);
-
-    auto queries = qtfile.get_queries();
-    for (auto &qry : queries) {
-        std::vector<double>      stage0_scores = trec_run.get_scores(qry.id);
-        std::vector<int>         docno_labels  = trec_run.get_labels(qry.id);
-        std::vector<std::string> docnos        = trec_run.get_result(qry.id);
-        std::vector<docid_t>     docids = qry_env.document_ids_from_metadata("docno", docnos);
-
-        auto start = clock::now();
-
-        for (size_t i = 0; i < docids.size(); ++i) {
-            auto const docid = docids[i];
-            auto const docno = docnos[i];
-            auto const label = docno_labels[i];
-
-            auto &doc_idx = fwd_idx[docid];
-
-            doc_entry doc_entry(docid, doc_idx.pagerank());
-
-            // set url_slash_count as feature for training
-            doc_entry.url_slash_count = doc_idx.url_slash_count();
-            doc_entry.url_length      = doc_idx.url_length();
-
-            // set original run score as a feature for training
-            doc_entry.stage0_score = stage0_scores[i];
-
-            f_bm25_atire.compute(qry, doc_entry, doc_idx, field_id_map);
-            f_bm25_trec3.compute(qry, doc_entry, doc_idx, field_id_map);
-            f_bm25_trec3_kmax.compute(qry, doc_entry, doc_idx, field_id_map);
-            f_lmds_2500.compute(qry, doc_entry, doc_idx, field_id_map);
-            f_lmds_1500.compute(qry, doc_entry, doc_idx, field_id_map);
-            f_lmds_1000.compute(qry, doc_entry, doc_idx, field_id_map);
-            tfidf_feature.compute(qry, doc_entry, doc_idx, field_id_map);
-            prob_feature.compute(qry, doc_entry, doc_idx, field_id_map);
-            be_feature.compute(qry, doc_entry, doc_idx, field_id_map);
-            dph_feature.compute(qry, doc_entry, doc_idx, field_id_map);
-            dfr_feature.compute(qry, doc_entry, doc_idx, field_id_map);
-            f_stream.compute(qry, doc_entry, doc_idx, field_id_map);
-            features.compute(qry, doc_entry, doc_idx, field_id_map);
-            prox_feature.compute(doc_entry, qry, doc_idx);
-            f_tpscore.compute(qry, doc_entry, doc_idx, field_id_map);
-
-            outfile << label << "," << qry.id << "," << docno << doc_entry << std::endl;
-        }
-        auto stop      = clock::now();
-        auto load_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-        std::cerr << "qid: " << qry.id << ", " << docids.size() << " docs in " << load_time.count()
-                  << " ms" << std::endl;
+    // scoring only reads the forward index, lexicon, queries and field ids, so the threads share
+    // them without locks and each owns its extractors
+    thread_pool                pool(threads);
+    pipeline extract;
+    if (!features_file.empty()) {
+        extract = select_pipeline(read_feature_names(features_file));
+    }
+    auto sweep_names = extractor_set(lexicon,
+                                     field_id_map,
+                                     settings.bm25,
+                                     settings.lm_mu,
+                                     extract,
+                                     settings.windows,
+                                     settings.tp_dist_windows)
+                           .sweep_names();
+    auto columns = doc_entry::names();
+    columns.insert(columns.end(), sweep_names.begin(), sweep_names.end());
+
+    auto &     queries = qtfile.get_queries();
+    store_plan plan;
+    if (stored) {
+        extract = open_store(
+            plan, store_file, lexicon, field_id_map, queries, trec_run, columns, settings);
+    }
+    std::vector<extractor_set> extractors(pool.size(),
+                                          extractor_set(lexicon,
+                                                        field_id_map,
+                                                        settings.bm25,
+                                                        settings.lm_mu,
+                                                        extract,
+                                                        settings.windows,
+                                                        settings.tp_dist_windows));
+    for (auto &&name : stored ? extractors[0].sweep_names() : std::vector<std::string>()) {
+        auto it = std::find(columns.begin(), columns.end(), name);
+        plan.sweep_columns.push_back(plan.columns[it - columns.begin()]);
+    }
+    if (!static_features_file.empty()) {
+        statics.check(fwd_idx.size(), lexicon, query_doc_view(field_id_map));
+        for (auto &&ex : extractors) {
+            ex.statics = &statics;
+        }
+    }
+    // tables sized for the longest query and a whole chunk are never reallocated
+    size_t max_terms = 0;
+    for (auto &&qry : qtfile.get_queries()) {
+        max_terms = std::max(max_terms, qry.tids.size());
+    }
+    for (auto &&ex : extractors) {
+        ex.reserve(chunk_size, max_terms);
+    }
+    if (!sweep_names.empty()) {
+        std::cerr << "Appending " << sweep_names.size() << " sweep features:";
+        for (auto &&name : sweep_names) {
+            std::cerr << " " << name;
+        }
+        std::cerr << std::endl;
+    }
+    // each thread times its own extractors, the profiles are summed at the end
+    bool profiling = !costs_file.empty() || !details_file.empty();
+    std::vector<feature_profile> profiles(pool.size(), feature_profile(extractor_count));
+    for (size_t t = 0; profiling && t < pool.size(); ++t) {
+        extractors[t].profile = &profiles[t];
+    }
+
+    // the output is rewritten, a rerun replaces its rows rather than adding them again
+    std::unique_ptr<npy_layout> npy;
+    if (binary) {
+        size_t value_size = format == "float32" ? sizeof(float) : sizeof(double);
+        npy.reset(new npy_layout(columns, value_size, trec_run.max_docno_length()));
+    }
+    auto mode = binary ? std::ofstream::binary | std::ofstream::trunc : std::ofstream::trunc;
+    async_writer outfile(output_file, mode);
+    if (binary) {
+        outfile.write(npy->header(0));
+    }
+
+    scoring ctx{fwd_idx,
+                resolver,
+                trec_run,
+                pool,
+                extractors,
+                stored ? &plan : nullptr,
+                npy.get(),
+                document_order};
+    size_t rows_written = score_runs(ctx, queries, outfile);
+
+    if (stored) {
+        rows_written += write_store_rows(plan, queries, trec_run, columns, npy.get(), outfile);
+        plan.store.write(store_file);
+    }
+    outfile.close();
+
+    if (binary) {
+        // the row count is only known now, the header keeps its length
+        std::fstream npy_file(output_file,
+                              std::fstream::in | std::fstream::out | std::fstream::binary);
+        npy_file << npy->header(rows_written);
+    }
+
+    if (profiling) {
+        for (size_t t = 1; t < profiles.size(); ++t) {
+            profiles[0] += profiles[t];
+        }
+        if (!costs_file.empty()) {
+            std::ofstream costs(costs_file);
+            for (double cost : feature_costs(profiles[0], doc_entry::names())) {
+                costs << std::max<long long>(1, std::llround(cost)) << '\n';
+            }
+            for (auto &&cost : query_costs) {
+                costs << cost << '\n';
+            }
+        }
+        if (!details_file.empty()) {
+            std::ofstream details(details_file);
+            profiles[0].write_details(details, extractor_names());
+        }
     }
     return 0;
 }
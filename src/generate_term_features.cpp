@@ -1,6 +1,8 @@
 #include <chrono>
 #include <iostream>
 #include <limits>
+#include <set>
+#include <sstream>
 #include <string>
 
 #include "CLI/CLI.hpp"
@@ -8,8 +10,67 @@
 
 #include "doc_lens.hpp"
 #include "inverted_index.hpp"
+#include "lexicon.hpp"
+#include "query_train_file.hpp"
 #include "term_feature.hpp"
 
+namespace {
+/* Number of statistics following the term in a line of the output file. */
+constexpr size_t feature_fields = 73;
+
+/* A unigram is keyed as (tid, 0), a bigram as (tid_a, tid_b). Id 0 is never a real term. */
+using term_key = std::pair<uint64_t, uint64_t>;
+
+bool make_key(Lexicon &lexicon, const std::vector<std::string> &terms, term_key &key) {
+    if (terms.empty() || terms.size() > 2) {
+        return false;
+    }
+    key = term_key(lexicon.term(terms[0]), 0);
+    if (terms.size() == 2) {
+        key.second = lexicon.term(terms[1]);
+    }
+    return !lexicon.is_oov(key.first) && !lexicon.is_oov(key.second);
+}
+
+/* Unigrams and ordered bigrams of the in-vocabulary query terms, a repeated term included. */
+void add_query_keys(Lexicon &lexicon, const query_train &qry, std::set<term_key> &keys) {
+    for (size_t i = 0; i < qry.tids.size(); ++i) {
+        if (lexicon.is_oov(qry.tids[i])) {
+            continue;
+        }
+        keys.insert(term_key(qry.tids[i], 0));
+        for (size_t j = 0; j < qry.tids.size(); ++j) {
+            if (j == i || lexicon.is_oov(qry.tids[j])) {
+                continue;
+            }
+            keys.insert(term_key(qry.tids[i], qry.tids[j]));
+        }
+    }
+}
+
+/* Keys of the terms an existing output file already holds statistics for. */
+void load_stored_keys(Lexicon &lexicon, const std::string &file, std::set<term_key> &keys) {
+    std::ifstream ifs(file);
+    std::string   line;
+    while (std::getline(ifs, line)) {
+        std::istringstream       iss(line);
+        std::vector<std::string> tokens;
+        std::string              tok;
+        while (iss >> tok) {
+            tokens.push_back(tok);
+        }
+        if (tokens.size() <= feature_fields) {
+            continue;
+        }
+        tokens.resize(tokens.size() - feature_fields);
+        term_key key;
+        if (make_key(lexicon, tokens, key)) {
+            keys.insert(key);
+        }
+    }
+}
+} // namespace
+
 int main(int argc, char **argv) {
     size_t done      = 0;
     size_t freq      = 0;
@@ -24,19 +85,32 @@ int main(int argc, char **argv) {
     std::string inverted_index_file;
     std::string doc_lens_file;
     std::string output_file;
+    std::string lexicon_file;
+    std::vector<std::string> query_files;
 
     CLI::App app{"Term features generation."};
     app.add_option("-i,--inverted-index", inverted_index_file, "Inverted index filename")
         ->required();
     app.add_option("-d,--doc-lens", doc_lens_file, "Document lens filename")->required();
     app.add_option("-o,--out-file", output_file, "Output filename")->required();
+    app.add_option("-q,--query-file",
+                   query_files,
+                   "Only add the terms of these query files missing from the output file");
+    app.add_option("-l,--lexicon", lexicon_file, "Lexicon filename, required with --query-file");
     CLI11_PARSE(app, argc, argv);
 
+    bool incremental = !query_files.empty();
+    if (incremental && lexicon_file.empty()) {
+        std::cerr << "--query-file requires --lexicon" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
     using clock = std::chrono::high_resolution_clock;
     InvertedIndex inv_idx;
     DocLens       doc_lens;
 
-    {
+    // the incremental mode reads the lists it wants from the file instead
+    if (!incremental) {
 
         auto start = clock::now();
 
@@ -63,6 +137,34 @@ int main(int argc, char **argv) {
                   << std::endl;
     }
 
+    Lexicon            lexicon;
+    std::set<term_key> wanted;
+    if (incremental) {
+        std::ifstream              ifs_lex(lexicon_file);
+        cereal::BinaryInputArchive iarchive_lex(ifs_lex);
+        iarchive_lex(lexicon);
+
+        for (auto &&query_file : query_files) {
+            std::ifstream ifs(query_file);
+            if (!ifs.is_open()) {
+                std::cerr << "Could not open file: " << query_file << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            query_train_file qtfile(ifs, lexicon);
+            for (auto &&qry : qtfile.get_queries()) {
+                add_query_keys(lexicon, qry, wanted);
+            }
+        }
+
+        std::set<term_key> stored;
+        load_stored_keys(lexicon, output_file, stored);
+        for (auto &&key : stored) {
+            wanted.erase(key);
+        }
+        std::cout << "Terms already stored: " << stored.size() << std::endl;
+        std::cout << "Query terms not stored: " << wanted.size() << std::endl;
+    }
+
     std::ofstream outfile(output_file, std::ofstream::app);
     outfile << std::fixed << std::setprecision(6);
 
@@ -73,15 +175,26 @@ int main(int argc, char **argv) {
     std::cout << "N. docs: " << ndocs << std::endl;
     std::cout << "Collection Length " << clen << std::endl;
 
-    for (auto &&pl : inv_idx) {
-        feature_t feature;
-        feature.term = pl.term;
-        feature.cf   = pl.totalCount;
-        feature.cdf  = pl.size();
-        auto list    = pl.list();
+    auto is_wanted = [&](const std::string &term) {
+        std::istringstream       iss(term);
+        std::vector<std::string> terms;
+        std::string              t;
+        while (iss >> t) {
+            terms.push_back(t);
+        }
+        term_key key;
+        return make_key(lexicon, terms, key) && wanted.count(key) > 0;
+    };
 
+    auto process = [&](PostingList &pl) {
         /* Min count is set to 4 or IQR computation goes boom. */
         if (pl.size() >= 4) {
+            feature_t feature;
+            feature.term = pl.term;
+            feature.cf   = pl.totalCount;
+            feature.cdf  = pl.size();
+            auto list    = pl.list();
+
             feature.geo_mean = compute_geo_mean(list.second);
             compute_tfidf_stats(feature, doc_lens, list, ndocs, tfidf_max);
             compute_bm25_stats(feature, doc_lens, list, ndocs, avg_dlen, bm25_max);
@@ -93,10 +206,32 @@ int main(int argc, char **argv) {
             outfile << feature;
             freq++;
         }
+    };
+
+    auto progress = [&]() {
         done++;
         if(done % 10000 == 0) {
             std::cout << "Processed " << done << " terms." << std::endl;
         }
+    };
+
+    if (incremental) {
+        // only the wanted lists are deserialized, the others are skipped in the file
+        InvertedIndexReader reader(inverted_index_file);
+        PostingList         pl;
+        std::string         term;
+        while (reader.next(term)) {
+            if (is_wanted(term)) {
+                reader.load(pl);
+                process(pl);
+            }
+            progress();
+        }
+    } else {
+        for (auto &&pl : inv_idx) {
+            process(pl);
+            progress();
+        }
     }
     std::cout << "Inv Lists Processed = " << done << std::endl;
     std::cout << "Inv Lists > 4 = " << freq << std::endl;
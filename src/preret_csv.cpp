@@ -1,38 +1,50 @@
-#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
+#include "preret_engine.hpp"
 #include "query_train_file.hpp"
-
-#include "fgen_bigram_qry.h"
-#include "fgen_term_qry.h"
-#include "query_features.h"
+#include "thread_pool.hpp"
 
 #include "CLI/CLI.hpp"
 #include "cereal/archives/binary.hpp"
 
-char *stdstr_to_cstr(const std::string &s) {
-    char *cstr = new char[s.size() + 1];
-    std::strcpy(cstr, s.c_str());
+namespace {
+/* Queries formatted between two writes to the output. */
+constexpr size_t batch_size = 4096;
 
-    return cstr;
+void format_row(int qid, const std::vector<double> &features, std::string &line) {
+    char buf[64];
+    line.assign(std::to_string(qid));
+    for (auto &&f : features) {
+        snprintf(buf, sizeof(buf), ",%.5f", f);
+        line.append(buf);
+    }
+    line.push_back('\n');
 }
+} // namespace
 
 int main(int argc, char **argv) {
     std::string query_file;
     std::string unigram_file;
     std::string bigram_file;
     std::string lexicon_file;
+    size_t      threads = 1;
 
     CLI::App app{"Merge unigram and bigram features."};
     app.add_option("query_file", query_file, "Query file")->required();
     app.add_option("unigram_file", unigram_file, "Unigram file")->required();
     app.add_option("bigram_file", bigram_file, "Bigram File")->required();
     app.add_option("lexicon_file", lexicon_file, "Lexicon file")->required();
+    app.add_option("-j,--threads", threads, "Number of threads", true);
     CLI11_PARSE(app, argc, argv);
 
-        // load lexicon
+    using clock = std::chrono::high_resolution_clock;
+
+    // load lexicon
     std::ifstream              lexicon_f(lexicon_file);
     cereal::BinaryInputArchive iarchive_lex(lexicon_f);
     Lexicon                    lexicon;
@@ -48,50 +60,32 @@ int main(int argc, char **argv) {
     ifs.close();
     ifs.clear();
 
-    // init static features
-    query_features_init(lexicon.document_count(), lexicon.term_count());
-
-    // load unigram features
-    std::cerr << "loading unigram features...";
-    termhash_t *termmap = NULL;
-    termmap             = load_termmap(unigram_file.c_str());
-    std::cerr << " done." << std::endl;
-
-    // load bigram features
-    std::cerr << "loading bigram features...";
-    bigramhash_t *bigrammap = NULL;
-    bigrammap               = load_bigrammap(bigram_file.c_str());
-    std::cerr << " done." << std::endl;
-
-    for (auto &qry : qtfile.get_queries()) {
-        std::vector<char *> stems;
-        std::transform(
-            qry.stems.begin(), qry.stems.end(), std::back_inserter(stems), stdstr_to_cstr);
-
-        char *buf_unigram, *buf_bigram;
-
-        // dump unigram features
-        buf_unigram = fgen_term_qry_main(termmap, qry.id, &stems[0], stems.size());
-        // dump bigram features
-        buf_bigram = fgen_bigram_qry_main(bigrammap, qry.id, &stems[0], stems.size());
-        std::string buf_common(buf_unigram);
-        buf_common.append(buf_bigram);
-        free(buf_unigram);
-        free(buf_bigram);
-
-        std::cout << qry.id;
-        if (buf_common.length()) {
-            std::cout << buf_common;
-        }
-        std::cout << std::endl;
-
-        for (auto cstr : stems) {
-            delete[] cstr;
+    auto          start = clock::now();
+    preret_engine engine(unigram_file, bigram_file, lexicon);
+    auto          stop      = clock::now();
+    auto          load_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    std::cerr << "Loaded " << unigram_file << " and " << bigram_file << " in "
+              << load_time.count() << " ms" << std::endl;
+
+    // one scratch and feature buffer per thread, rows are written in query file order
+    thread_pool                         pool(threads);
+    std::vector<preret_engine::scratch> scratch(pool.size());
+    std::vector<std::vector<double>>    features(pool.size(),
+                                              std::vector<double>(preret_engine::size()));
+    std::vector<std::string>            lines(batch_size);
+    const auto &                        queries = qtfile.get_queries();
+
+    for (size_t begin = 0; begin < queries.size(); begin += batch_size) {
+        size_t n = std::min(batch_size, queries.size() - begin);
+        pool.parallel_for(n, [&](size_t i, size_t t) {
+            const auto &qry = queries[begin + i];
+            engine.compute(qry, features[t].data(), scratch[t]);
+            format_row(qry.id, features[t], lines[i]);
+        });
+        for (size_t i = 0; i < n; ++i) {
+            std::cout << lines[i];
         }
     }
 
-    destroy_termhash(termmap);
-    destroy_bigramhash(bigrammap);
-
     return 0;
 }
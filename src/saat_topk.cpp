@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CLI/CLI.hpp"
+#include "cereal/archives/binary.hpp"
+
+#include "docno_map.hpp"
+#include "impact_index.hpp"
+#include "lexicon.hpp"
+#include "query_train_file.hpp"
+#include "saat_retriever.hpp"
+
+int main(int argc, char **argv) {
+    std::string query_file;
+    std::string impact_index_file;
+    std::string docno_map_file;
+    std::string output_file;
+    std::string run_id = "saat";
+    size_t      depth  = 1000;
+    size_t      budget = 0;
+
+    CLI::App app{"Stage 0 BM25 run read score-at-a-time from an impact-ordered index."};
+    app.add_option("query_file", query_file, "Query file")->required();
+    app.add_option("impact_index_file", impact_index_file, "Index from create_impact_index")
+        ->required();
+    app.add_option("docno_map_file", docno_map_file, "Docno map from create_forward_index")
+        ->required();
+    app.add_option("output_file", output_file, "Output TREC run file")->required();
+    app.add_option("-k,--depth", depth, "Documents per query", true);
+    app.add_option("-p,--postings", budget, "Postings read per query, 0 for all", true);
+    app.add_option("--run-id", run_id, "Run id of the output", true);
+    CLI11_PARSE(app, argc, argv);
+
+    using clock = std::chrono::high_resolution_clock;
+    auto start  = clock::now();
+
+    ImpactIndex impact_idx;
+    {
+        std::ifstream              ifs_idx(impact_index_file);
+        cereal::BinaryInputArchive iarchive_idx(ifs_idx);
+        iarchive_idx(impact_idx);
+    }
+    docno_map docnos(docno_map_file);
+
+    auto stop      = clock::now();
+    auto load_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    std::cerr << "Loaded " << impact_index_file << " in " << load_time.count() << " ms"
+              << std::endl;
+
+    std::ifstream ifs(query_file);
+    if (!ifs.is_open()) {
+        std::cerr << "Could not open file: " << query_file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    // only the stems of the queries are read
+    Lexicon          lexicon;
+    query_train_file qtfile(ifs, lexicon);
+
+    std::ofstream outfile(output_file);
+    if (!outfile.is_open()) {
+        std::cerr << "Could not open file: " << output_file << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    saat_retriever                      retriever(impact_idx);
+    clock::duration                     time{0};
+    clock::duration                     slowest{0};
+    std::vector<saat_retriever::result> results;
+    char                                buf[64];
+    for (auto &&qry : qtfile.get_queries()) {
+        start   = clock::now();
+        results = retriever.search(qry.stems, depth, budget);
+        auto t  = clock::now() - start;
+        time += t;
+        slowest = std::max(slowest, t);
+        for (size_t r = 0; r < results.size(); ++r) {
+            snprintf(buf, sizeof(buf), " %zu %f ", r + 1, results[r].score);
+            outfile << qry.id << " Q0 " << docnos.docno(results[r].docid) << buf << run_id << "\n";
+        }
+    }
+
+    using ms     = std::chrono::duration<double, std::milli>;
+    auto queries = qtfile.get_queries().size();
+    std::cerr << queries << " queries in " << ms(time).count() << " ms, slowest "
+              << ms(slowest).count() << " ms, " << retriever.postings() << " postings read"
+              << std::endl;
+    return 0;
+}
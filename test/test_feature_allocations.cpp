@@ -0,0 +1,191 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "feature_pipeline.hpp"
+
+/*
+ * Checks that once `extractor_set::reserve` has sized its tables, scoring documents does not
+ * allocate. Every extractor and sweep runs over a synthetic collection, and `operator new` is
+ * counted while the batches of queries of every length are scored.
+ */
+
+static bool   counting    = false;
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    void *p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept { std::free(p); }
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+const std::vector<std::string> idx_fields = {
+    "title", "heading", "mainbody", "inlink", "applet", "object", "embed"};
+const size_t vocabulary = 16;
+const size_t num_docs   = 300;
+const size_t batch_size = 64;
+
+/* A linear congruential generator, the collection is the same on every run. */
+struct lcg {
+    uint64_t state = 42;
+
+    size_t operator()(size_t n) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (state >> 33) % n;
+    }
+};
+
+/* Documents of `vocabulary` terms, each position in one of the fields of `field_id_map`. */
+ForwardIndex make_documents(const FieldIdMap &field_id_map, lcg &rand) {
+    ForwardIndex fwd_idx(num_docs);
+    for (auto &&doc : fwd_idx) {
+        size_t                             len = 5 + rand(200);
+        std::vector<uint32_t>              terms;
+        std::vector<std::vector<uint32_t>> positions(vocabulary);
+        for (uint32_t p = 0; p < len; ++p) {
+            uint32_t tid = rand(vocabulary);
+            terms.push_back(tid);
+            positions[tid].push_back(p);
+        }
+        doc.set_terms(terms);
+        for (uint32_t tid = 0; tid < vocabulary; ++tid) {
+            if (positions[tid].empty()) {
+                continue;
+            }
+            doc.set_positions(tid, positions[tid]);
+            for (auto &&f : field_id_map) {
+                doc.set_freq(f.second, tid, rand(positions[tid].size() + 1));
+            }
+        }
+        for (auto &&f : field_id_map) {
+            doc.set_tag_count(f.second, rand(4));
+            doc.set_field_len(f.second, rand(len + 1));
+        }
+        doc.set_pagerank(rand(1000) / 1000.0);
+    }
+    return fwd_idx;
+}
+
+/* Counts of the terms and fields of `fwd_idx`. */
+Lexicon make_lexicon(const ForwardIndex &fwd_idx, const FieldIdMap &field_id_map) {
+    uint64_t                 total = 0;
+    std::vector<Counts>      counts(vocabulary);
+    std::vector<FieldCounts> field_counts(vocabulary);
+    for (auto &&doc : fwd_idx) {
+        total += doc.length();
+        for (uint32_t tid = 0; tid < vocabulary; ++tid) {
+            if (doc.freq(tid) == 0) {
+                continue;
+            }
+            counts[tid].document_count += 1;
+            counts[tid].term_count += doc.freq(tid);
+            for (auto &&f : field_id_map) {
+                auto &fc = field_counts[tid][f.second];
+                fc.document_count += doc.freq(f.second, tid) > 0;
+                fc.term_count += doc.freq(f.second, tid);
+            }
+        }
+    }
+    Lexicon lexicon(Counts(fwd_idx.size(), total));
+    for (uint32_t tid = 0; tid < vocabulary; ++tid) {
+        lexicon.push_back("t" + std::to_string(tid), counts[tid], field_counts[tid]);
+    }
+    return lexicon;
+}
+
+/* Queries of one to six terms, the longer ones with a repeated term. */
+std::vector<query_train> make_queries(lcg &rand) {
+    std::vector<query_train> queries;
+    for (int id = 1; id <= 12; ++id) {
+        query_train qry;
+        qry.id = id;
+        for (int i = 0; i < 1 + (id * 5) % 6; ++i) {
+            uint64_t tid = i == 4 ? qry.tids[0] : rand(vocabulary);
+            qry.stems.push_back("t" + std::to_string(tid));
+            qry.tids.push_back(tid);
+            qry.pos.push_back(i);
+            qry.q_ft[tid] += 1;
+        }
+        queries.push_back(qry);
+    }
+    return queries;
+}
+
+}  // namespace
+
+int main() {
+    FieldIdMap field_id_map;
+    for (size_t f = 0; f < idx_fields.size(); ++f) {
+        field_id_map.insert(std::make_pair(idx_fields[f], int(f) + 1));
+    }
+    lcg          rand;
+    ForwardIndex fwd_idx = make_documents(field_id_map, rand);
+    Lexicon      lexicon = make_lexicon(fwd_idx, field_id_map);
+    auto         queries = make_queries(rand);
+
+    std::vector<proximity_window> windows(2);
+    windows[1].window  = 12;
+    windows[1].ordered = true;
+
+    extractor_set ex(lexicon,
+                     field_id_map,
+                     batch_scorer::grid({0.9, 1.2}, {0.4}),
+                     {800.0},
+                     pipeline(),
+                     windows,
+                     {50});
+    size_t max_terms = 0;
+    for (auto &&qry : queries) {
+        max_terms = std::max(max_terms, qry.tids.size());
+    }
+    ex.reserve(batch_size, max_terms);
+
+    std::vector<const Document *> docs;
+    std::vector<int>              docids;
+    std::vector<double>           row;
+    docs.reserve(batch_size);
+    docids.reserve(batch_size);
+    row.reserve(doc_entry::names().size() + ex.sweep_names().size());
+    size_t scored = 0;
+    for (auto &&qry : queries) {
+        // batches of every size up to the reserved one
+        size_t batch = 1 + rand(batch_size);
+        docs.clear();
+        docids.clear();
+        for (size_t k = 0; k < batch; ++k) {
+            docids.push_back(rand(num_docs));
+            docs.push_back(&fwd_idx[docids.back()]);
+        }
+        counting = true;
+        ex.score_batch(qry, docs, docids);
+        for (size_t k = 0; k < batch; ++k) {
+            auto doc = ex.entry(k, docids[k], *docs[k], 1.0);
+            row.clear();
+            doc.visit([&](const char *, double value) { row.push_back(value); });
+            ex.visit_sweep(k, [&](double value) { row.push_back(value); });
+        }
+        counting = false;
+        scored += batch;
+    }
+
+    if (allocations != 0) {
+        std::cerr << allocations << " allocations scoring " << scored << " documents" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Scored " << scored << " documents without allocating" << std::endl;
+    return EXIT_SUCCESS;
+}